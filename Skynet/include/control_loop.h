@@ -0,0 +1,21 @@
+//  ***************************************************************************
+/// @file    control_loop.h
+/// @author  NeoProg
+/// @brief   Frame synchronous control loop (PendSV)
+//  ***************************************************************************
+#ifndef CONTROL_LOOP_H_
+#define CONTROL_LOOP_H_
+
+#include <stdint.h>
+
+
+extern uint16_t control_loop_latency;          // Read only
+extern uint16_t control_loop_latency_max;      // Read only
+
+
+extern void control_loop_init(void);
+extern void control_loop_lock(void);
+extern void control_loop_unlock(void);
+
+
+#endif /* CONTROL_LOOP_H_ */
@@ -0,0 +1,18 @@
+//  ***************************************************************************
+/// @file    crc16.h
+/// @author  NeoProg
+/// @brief   CRC16 (ModBus) calculation
+//  ***************************************************************************
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_INIT_VALUE                        (0xFFFF)
+
+
+extern uint16_t crc16_update(uint16_t crc, const uint8_t* data, uint32_t size);
+extern uint16_t crc16_calculate(const uint8_t* data, uint32_t size);
+
+
+#endif /* CRC16_H_ */
@@ -0,0 +1,19 @@
+//  ***************************************************************************
+/// @file    emergency_stop.h
+/// @author  NeoProg
+/// @brief   Emergency stop frame detection in USART ISR
+//  ***************************************************************************
+#ifndef EMERGENCY_STOP_H_
+#define EMERGENCY_STOP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EMERGENCY_STOP_FRAME_SIZE           (7)     // [0xFE][0x4D]['S']['T']['P'][CRC16]
+
+
+extern void emergency_stop_check_frame(const uint8_t* frame, uint32_t size);
+extern bool emergency_stop_is_active(void);
+
+
+#endif /* EMERGENCY_STOP_H_ */
@@ -17,7 +17,8 @@ typedef enum {
     ERROR_MODULE_MOVEMENT_ENGINE = 0x0800,
     ERROR_MODULE_MONITORING      = 0x1000,
     ERROR_MODULE_GUI             = 0x2000,
-	ERROR_MODULE_ORIENTATION     = 0x4000
+	ERROR_MODULE_ORIENTATION     = 0x4000,
+    ERROR_MODULE_EMERGENCY_STOP  = 0x8000
 } error_module_name_t;
 
 
@@ -37,6 +38,7 @@ extern void callback_set_voltage_error(void);
 extern void callback_set_sync_error(error_module_name_t module);
 extern void callback_set_math_error(error_module_name_t module);
 extern void callback_set_i2c_error(error_module_name_t module);
+extern void callback_set_emergency_stop(void);
 
 extern bool callback_is_emergency_mode_active(void);
 extern bool callback_is_any_error_set(void);
@@ -0,0 +1,24 @@
+//  ***************************************************************************
+/// @file    foot_target.h
+/// @author  NeoProg
+/// @brief   Foot targets stream decoder
+//  ***************************************************************************
+#ifndef FOOT_TARGET_H_
+#define FOOT_TARGET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "limbs_driver.h"
+
+#define FOOT_TARGET_FRAME_SIZE              (1 + SUPPORT_LIMB_COUNT * 6)    // [sequence][X, Y, Z (int16, mm) x 6]
+#define FOOT_TARGET_RESPONSE_SIZE           (2)                             // [sequence][error mask]
+
+
+extern uint16_t foot_target_error_count;    // Read only: rejected frames with bad targets
+extern uint8_t  foot_target_error_mask;     // Read only: limbs with bad target in last frame
+
+
+extern bool foot_target_process_frame(const uint8_t* frame, uint8_t* response);
+
+
+#endif /* FOOT_TARGET_H_ */
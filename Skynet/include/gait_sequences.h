@@ -24,7 +24,7 @@ typedef struct {
     limb_state_t limb_state_list[SUPPORT_LIMB_COUNT];
     point_3d_t   point_list[SUPPORT_LIMB_COUNT];
     path_type_t  path_list[SUPPORT_LIMB_COUNT];
-    uint32_t     smooth_point_count;
+    uint32_t     smooth_point_count;                            // For LIMBS_DRIVER_BASE_FRAME_RATE_HZ frame rate
 } sequence_iteration_t;
 
 typedef struct {
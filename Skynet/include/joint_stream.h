@@ -0,0 +1,27 @@
+//  ***************************************************************************
+/// @file    joint_stream.h
+/// @author  NeoProg
+/// @brief   Joint angles streaming with jitter buffer
+//  ***************************************************************************
+#ifndef JOINT_STREAM_H_
+#define JOINT_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "limbs_driver.h"
+
+#define JOINT_STREAM_JOINT_COUNT            (SUPPORT_LIMB_COUNT * 3)
+#define JOINT_STREAM_FRAME_SIZE             (4 + JOINT_STREAM_JOINT_COUNT * 2)  // [timestamp (us)][angles (int16, 0.1 deg)]
+#define JOINT_STREAM_BUFFER_SIZE            (8)
+
+
+extern uint16_t joint_stream_underrun_count;    // Read only: frames with empty buffer (last angles hold)
+extern uint16_t joint_stream_drop_count;        // Read only: late or skipped frames
+extern uint8_t  joint_stream_buffer_level;      // Read only
+
+
+extern bool joint_stream_push_frame(const uint8_t* frame);
+extern bool joint_stream_get_angles(float* angles);
+
+
+#endif /* JOINT_STREAM_H_ */
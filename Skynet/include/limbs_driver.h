@@ -10,6 +10,7 @@
 #include <stdbool.h>
 
 #define SUPPORT_LIMB_COUNT                (6)
+#define LIMBS_DRIVER_BASE_FRAME_RATE_HZ   (150)     // Frame rate for smooth point count values in gait sequences
 
 
 typedef struct {
@@ -28,6 +29,7 @@ typedef enum {
 
 extern int8_t ram_link_angles_override[SUPPORT_LIMB_COUNT * 3];    // Write only
 extern int8_t ram_link_angles[SUPPORT_LIMB_COUNT * 3];            // Read only
+extern uint16_t ram_limbs_calc_time_max;                        // Read only
 
 
 extern void limbs_driver_init(void);
@@ -35,6 +37,7 @@ extern void limbs_driver_set_smooth_config(uint32_t point_count);
 extern void limbs_driver_start_move(const point_3d_t* point_list, const path_type_t* path_type_list);
 extern void limbs_driver_process(void);
 extern bool limbs_driver_is_move_complete(void);
+extern bool limbs_driver_set_foot_targets(const point_3d_t* targets, uint8_t* error_mask);
 
 
 #endif /* LIMB_H_ */
\ No newline at end of file
@@ -6,6 +6,31 @@
 #ifndef MODBUS_H_
 #define MODBUS_H_
 
+#include <stdint.h>
+
+#define MODBUS_PORT_COUNT                       (2)         // USART0, USART1
+#define MODBUS_LATENCY_HIST_SIZE                (5)         // < 100us, < 500us, < 1ms, < 5ms, >= 5ms
+#define MODBUS_HANDLER_TIME_HIST_SIZE           (5)         // < 10us, < 50us, < 200us, < 1ms, >= 1ms
+
+
+typedef struct {
+    uint16_t request_count;                                 // Processed valid requests (exceptions included)
+    uint16_t usart_error_count;                             // Overrun, framing or parity errors
+    uint16_t bad_size_count;                                // Frame too short or bad size for command
+    uint16_t bad_address_count;                             // Frame for other device
+    uint16_t bad_crc_count;
+    uint16_t unknown_function_count;
+    uint16_t exception_count;                               // Exception responses
+    uint16_t tx_busy_count;                                 // Frames waited previous response transmit
+    uint16_t latency_max;                                   // Max frame receive -> response start time [us]
+    uint16_t handler_time_max;                              // Max command handler time [us]
+    uint16_t latency_hist[MODBUS_LATENCY_HIST_SIZE];
+    uint16_t handler_time_hist[MODBUS_HANDLER_TIME_HIST_SIZE];
+} modbus_port_statistic_t;
+
+
+extern modbus_port_statistic_t modbus_statistic[MODBUS_PORT_COUNT];    // Read only
+
 
 void modbus_init(void);
 void modbus_process(void);
@@ -38,6 +38,7 @@ extern void movement_engine_init(void);
 extern void movement_engine_process(void);
 extern void movement_engine_increase_height(void);
 extern void movement_engine_decrease_height(void);
+extern void movement_engine_set_height(int32_t height);
 extern void movement_engine_select_sequence(sequence_id_t sequence);
 
 
@@ -0,0 +1,20 @@
+//  ***************************************************************************
+/// @file    multimedia.h
+/// @author  NeoProg
+/// @brief   Bulk data export by chunks
+//  ***************************************************************************
+#ifndef MULTIMEDIA_H_
+#define MULTIMEDIA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MULTIMEDIA_BLOB_OLED_FRAME_BUFFER   (0x0000)    // 8 rows x 128 columns, snapshot on size request
+#define MULTIMEDIA_BLOB_TRAJECTORY          (0x0001)    // Trajectory buffer, int16 little-endian
+
+
+extern bool     multimedia_get_blob_size(uint32_t blob_id, uint32_t* size);
+extern uint32_t multimedia_read(uint32_t blob_id, uint32_t offset, uint8_t* buffer, uint32_t bytes_count);
+
+
+#endif /* MULTIMEDIA_H_ */
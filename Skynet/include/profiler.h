@@ -0,0 +1,32 @@
+//  ***************************************************************************
+/// @file    profiler.h
+/// @author  NeoProg
+/// @brief   Tasks execution time profiler
+//  ***************************************************************************
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#define PROFILER_HIST_SIZE                  (3)     // < 100us, < 1000us, >= 1000us
+
+
+typedef struct {
+    uint16_t min;                           // Min execution time [us]
+    uint16_t avg;                           // Average execution time [us]
+    uint16_t max;                           // Max execution time [us]
+    uint16_t hist[PROFILER_HIST_SIZE];      // Execution time histogram
+} profiler_statistic_t;
+
+
+extern uint16_t profiler_loop_frequency;                            // Read only
+extern profiler_statistic_t profiler_statistic[SUPPORT_TASK_COUNT]; // Read only
+
+
+extern void profiler_reset(void);
+extern void profiler_loop_process(void);
+extern void profiler_task_complete(task_id_t id, uint32_t exec_time);
+
+
+#endif /* PROFILER_H_ */
@@ -9,7 +9,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define RAM_MAP_SIZE                    (512)
+#define RAM_MAP_SIZE                    (0x7000)    // Include trajectory buffer
 #define RAM_MAP_BEGIN_ADDRESS           (0x0000)
 #define RAM_MAP_END_ADDRESS             (RAM_MAP_BEGIN_ADDRESS + RAM_MAP_SIZE)
 
@@ -0,0 +1,58 @@
+//  ***************************************************************************
+/// @file    scheduler.h
+/// @author  NeoProg
+/// @brief   Rate group cooperative scheduler
+//  ***************************************************************************
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+typedef enum {
+    TASK_PERIOD_1KHZ,
+    TASK_PERIOD_100HZ,
+    TASK_PERIOD_10HZ,
+    TASK_PERIOD_BACKGROUND      // Once per scheduler pass
+} task_period_t;
+
+typedef enum {
+    TASK_ID_SYSTEM_STATUS,
+    TASK_ID_LIMBS_DRIVER,       // Control loop (PendSV) module, profiler ID only
+    TASK_ID_MOVEMENT_ENGINE,    // Control loop (PendSV) module, profiler ID only
+    TASK_ID_SERVO_DRIVER,       // Control loop (PendSV) module, profiler ID only
+    TASK_ID_MODBUS,
+    TASK_ID_ORIENTATION,
+    TASK_ID_SCR,
+    TASK_ID_GUI,
+    TASK_ID_BUZZER,
+    TASK_ID_LED,
+    TASK_ID_MONITORING,
+    TASK_ID_WIRELESS_MODBUS,
+    TASK_ID_TELEOP,
+    TASK_ID_VEEPROM,
+    SUPPORT_TASK_COUNT
+} task_id_t;
+
+typedef struct {
+    task_id_t     id;
+    task_period_t period;
+    uint32_t      budget;               // Execution time budget [us]
+    bool          is_sheddable;         // Task skipped in degraded mode
+    void        (*process)(void);
+    uint32_t      last_run;             // Internal: time [ms] of last run
+} scheduler_task_t;
+
+
+extern uint16_t scheduler_overrun_count[SUPPORT_TASK_COUNT];    // Read only
+extern uint32_t scheduler_missed_frame_count;                   // Read only
+extern uint16_t scheduler_recovery_count;                       // Read only
+extern uint8_t  scheduler_degraded_mode;                        // Read only
+
+
+extern void scheduler_process(scheduler_task_t* task_list, uint32_t task_count);
+extern void scheduler_frame_complete(uint32_t missed_frame_count);
+
+
+#endif /* SCHEDULER_H_ */
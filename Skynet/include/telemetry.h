@@ -0,0 +1,36 @@
+//  ***************************************************************************
+/// @file    telemetry.h
+/// @author  NeoProg
+/// @brief   Subscription based telemetry publisher
+//  ***************************************************************************
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wireless_modbus.h"
+
+#define TELEMETRY_MAX_RANGE_COUNT           (32)
+#define TELEMETRY_MAX_SNAPSHOT_SIZE         (512)   // Total size of subscribed RAM ranges
+#define TELEMETRY_KEYFRAME_INTERVAL         (50)    // Full snapshot every N frames
+
+#define TELEMETRY_FRAME_TYPE_KEYFRAME       (0x00)  // Payload: snapshot
+#define TELEMETRY_FRAME_TYPE_DELTA          (0x01)  // Payload: changed bytes mask + changed bytes
+
+
+// Telemetry frame data header. Payload follows header
+typedef struct __attribute__ ((packed)) {
+    uint32_t sequence;                      // Frame sequence number (loss detection)
+    uint32_t timestamp;                     // Snapshot time [us]
+    uint8_t  type;                          // Frame type
+    uint16_t snapshot_size;                 // Snapshot size
+} telemetry_header_t;
+
+
+extern bool     telemetry_subscribe(const wireless_ram_range_t* ranges, uint32_t range_count, uint32_t period);
+extern void     telemetry_unsubscribe(void);
+extern bool     telemetry_is_push_required(void);
+extern uint32_t telemetry_make_frame(wireless_frame_t* frame);
+
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,35 @@
+//  ***************************************************************************
+/// @file    teleop.h
+/// @author  NeoProg
+/// @brief   Teleoperation command decoder
+//  ***************************************************************************
+#ifndef TELEOP_H_
+#define TELEOP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TELEOP_COMMAND_SIZE                 (9)     // [sequence][mode][speed][turn][height][host timestamp]
+
+#define TELEOP_MODE_IDLE                    (0x00)  // Stop movement
+#define TELEOP_MODE_WALK                    (0x01)  // Movement by speed and turn
+#define TELEOP_MODE_UP                      (0x02)
+#define TELEOP_MODE_DOWN                    (0x03)
+#define TELEOP_MODE_ATTACK_LEFT             (0x04)
+#define TELEOP_MODE_ATTACK_RIGHT            (0x05)
+#define TELEOP_MODE_DANCE                   (0x06)
+
+
+extern uint16_t teleop_latency;             // Read only: command decode -> servo frame commit [us]
+extern uint16_t teleop_latency_max;         // Read only
+extern uint8_t  teleop_sequence;            // Read only: last accepted command sequence number
+extern uint16_t teleop_actuation_latency;   // Read only: host command transmit -> servo frame commit [us]
+extern uint16_t teleop_actuation_latency_max;   // Read only
+
+
+extern void teleop_process(void);
+extern bool teleop_process_command(const uint8_t* command);
+extern void teleop_frame_committed(void);
+
+
+#endif /* TELEOP_H_ */
@@ -0,0 +1,28 @@
+//  ***************************************************************************
+/// @file    time_sync.h
+/// @author  NeoProg
+/// @brief   Host clock synchronization
+//  ***************************************************************************
+#ifndef TIME_SYNC_H_
+#define TIME_SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIME_SYNC_REQUEST_SIZE              (8)     // [host transmit time][host receive time of previous response]
+#define TIME_SYNC_RESPONSE_SIZE             (20)    // [host transmit time][receive time][transmit time][offset][delay]
+
+
+extern int32_t  time_sync_offset;           // Read only: local time - host time [us]
+extern int32_t  time_sync_drift;            // Read only: local clock drift relative host clock [ppb]
+extern uint32_t time_sync_delay;            // Read only: last round trip delay [us]
+extern uint16_t time_sync_sample_count;     // Read only
+
+
+extern void     time_sync_process_request(const uint8_t* request, uint8_t* response);
+extern bool     time_sync_is_valid(void);
+extern uint32_t time_sync_host_to_local(uint32_t host_time);
+extern uint32_t time_sync_local_to_host(uint32_t local_time);
+
+
+#endif /* TIME_SYNC_H_ */
@@ -0,0 +1,39 @@
+//  ***************************************************************************
+/// @file    trajectory.h
+/// @author  NeoProg
+/// @brief   Trajectory buffer with frame synchronous playback
+//  ***************************************************************************
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "limbs_driver.h"
+
+#define TRAJECTORY_POINT_SIZE               (SUPPORT_LIMB_COUNT * 3)    // int16 values per point
+#define TRAJECTORY_MAX_POINT_COUNT          (680)                       // 4.5 s at 150 Hz
+
+#define TRAJECTORY_TYPE_JOINTS              (0x00)  // Point: link angles (int16, 0.1 deg) x 18
+#define TRAJECTORY_TYPE_FOOT_TARGETS        (0x01)  // Point: X, Y, Z (int16, mm) x 6
+
+#define TRAJECTORY_STATE_STOPPED            (0x00)
+#define TRAJECTORY_STATE_PLAYING            (0x01)
+#define TRAJECTORY_STATE_ERROR              (0x02)  // Bad configuration or unreachable point
+
+
+extern int16_t  trajectory_buffer[TRAJECTORY_MAX_POINT_COUNT][TRAJECTORY_POINT_SIZE];  // Read/Write
+extern uint8_t  trajectory_type;            // Read/Write
+extern uint8_t  trajectory_frame_period;    // Read/Write: PWM frames per point
+extern uint16_t trajectory_point_count;     // Read/Write
+extern uint8_t  trajectory_state;           // Read only
+extern uint16_t trajectory_position;        // Read only: current point
+
+
+extern bool trajectory_play(bool is_loop);
+extern void trajectory_stop(void);
+extern bool trajectory_seek(uint32_t point);
+extern void trajectory_abort(void);
+extern const int16_t* trajectory_get_point(void);
+
+
+#endif /* TRAJECTORY_H_ */
@@ -10,7 +10,12 @@
 #include <stdbool.h>
 
 
+extern uint16_t veeprom_flash_write_count;     // Read only
+
+
 void veeprom_init(void);
+void veeprom_process(void);
+bool veeprom_commit(void);
 bool veeprom_update_checksum(void);
 
 uint8_t  veeprom_read_8(uint32_t veeprom_address);
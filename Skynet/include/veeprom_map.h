@@ -44,5 +44,8 @@
 #define BATTERY_LOW_VOLTAGE_THRESHOLD_EE_ADDRESS        (0x0650)
 #define FRONT_DISTANCE_LOW_LIMIT_EE_ADDRESS				(0x0660)
 
+#define PWM_PULSE_STAGGER_STEP_EE_ADDRESS               (0x0670)   ///< U16 Pulse start stagger step [us], 0xFFFF - disabled
+#define PWM_FREQUENCY_EE_ADDRESS                        (0x0672)   ///< U16 PWM frame rate [Hz], 0xFFFF - default (150Hz)
+
 
 #endif /* VEEPROM_MAP_H_ */
\ No newline at end of file
@@ -12,11 +12,18 @@
 #define WIRELESS_MODBUS_FRAME_SIZE						(sizeof(wireless_frame_t))
 #define WIRELESS_MODBUS_FRAME_DATA_SIZE					(1017)
 #define WIRELESS_MODBUS_FRAME_CRC_SIZE					(2)
+#define WIRELESS_MODBUS_MULTIMEDIA_OFFSET_SIZE			(4)		// Chunk offset (uint32) before chunk data
+#define WIRELESS_MODBUS_MULTIMEDIA_MAX_CHUNK_SIZE		(WIRELESS_MODBUS_FRAME_DATA_SIZE - WIRELESS_MODBUS_MULTIMEDIA_OFFSET_SIZE)
 
 #define WIRELESS_MODBUS_CMD_WRITE_RAM					(0x41)	// Function Code: Write RAM
 #define WIRELESS_MODBUS_CMD_READ_RAM					(0x44)	// Function Code: Read RAM
-#define WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA_SIZE	(0x60)	// Function Code: Read multimedia data size
-#define WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA		(0x61)	// Function Code: Read multimedia data
+#define WIRELESS_MODBUS_CMD_READ_RAM_RANGES				(0x48)	// Function Code: Read several RAM ranges
+#define WIRELESS_MODBUS_CMD_SUBSCRIBE_TELEMETRY			(0x49)	// Function Code: Subscribe to telemetry (address - period [ms], 0 - unsubscribe)
+#define WIRELESS_MODBUS_CMD_TELEMETRY					(0x4A)	// Function Code: Telemetry frame (device -> host only)
+#define WIRELESS_MODBUS_CMD_FOOT_TARGETS				(0x4F)	// Function Code: Foot targets stream frame
+#define WIRELESS_MODBUS_CMD_TIME_SYNC					(0x50)	// Function Code: Host clock synchronization
+#define WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA_SIZE	(0x60)	// Function Code: Read multimedia data size (address - blob ID)
+#define WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA		(0x61)	// Function Code: Read multimedia data chunk (address - blob ID)
 #define WIRELESS_MODBUS_EXCEPTION						(0x80)	// Function Code: Exception
 
 
@@ -31,6 +38,16 @@ typedef struct __attribute__ ((packed)) {
 	
 } wireless_frame_t;
 
+// RAM range descriptor for read several RAM ranges command.
+// Request: bytes_count - ranges count, data - descriptors list
+// Response: bytes_count - total bytes count, data - ranges data
+typedef struct __attribute__ ((packed)) {
+
+	uint16_t address;
+	uint16_t bytes_count;
+	
+} wireless_ram_range_t;
+
 
 extern void wireless_modbus_init(void);
 extern void wireless_modbus_process(void);
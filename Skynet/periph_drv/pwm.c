@@ -5,11 +5,21 @@
 #include <sam.h>
 #include "pwm.h"
 
-#define PWM_FREQUENCY_HZ                (150)
+#define PWM_PERIOD_US                   (1000000 / pwm_frequency)
+#define PWM_MAX_PULSE_WIDTH_US          (2500)
 #define TIMER_CLOCK_FREQUENCY           (SystemCoreClock / 2)
-#define PWM_PERIOD_TICKS                (TIMER_CLOCK_FREQUENCY / PWM_FREQUENCY_HZ)
+#define PWM_PERIOD_TICKS                (TIMER_CLOCK_FREQUENCY / pwm_frequency)
 #define US_TO_TICKS(_width)             ((TIMER_CLOCK_FREQUENCY / 1000000) * (_width))
 
+#define PWM_CHANNELS_PER_GROUP          (3)     // One TC channel (RA, RB, RC) drive one group (one limb)
+#define PWM_GROUP_COUNT                 (6)
+#define PWM_SLOT_COUNT                  (3)     // Pulse start slots: sync timer RC (frame start), RA and RB
+
+#define PWM_DENSITY_BIN_COUNT           (32)    // Frame is split to bins, bin width follow frame period
+
+#define TICKS_TO_CYCLES(_ticks)         ((_ticks) * 2)      // Timer clock is MCK / 2
+#define US_TO_CYCLES(_us)               ((SystemCoreClock / 1000000) * (_us))
+
 #define PWM_CH0_PIN                     (PIO_PC13)
 #define PWM_CH1_PIN                     (PIO_PB21)
 #define PWM_CH2_PIN                     (PIO_PB14)
@@ -37,9 +47,66 @@
 #define PWM_ALL_PINS_PORTD              (PWM_CH9_PIN  | PWM_CH10_PIN  | PWM_CH11_PIN | PWM_CH12_PIN)
 
 
+typedef struct {
+    uint32_t porta;
+    uint32_t portb;
+    uint32_t portc;
+    uint32_t portd;
+} pwm_pins_t;
+
+
+static TcChannel* const group_timers[PWM_GROUP_COUNT] = {
+    &TC1->TC_CHANNEL[0], &TC1->TC_CHANNEL[1], &TC1->TC_CHANNEL[2],
+    &TC2->TC_CHANNEL[0], &TC2->TC_CHANNEL[1], &TC2->TC_CHANNEL[2]
+};
+
+static const pwm_pins_t group_pins[PWM_GROUP_COUNT] = {
+    { .portb = PWM_CH1_PIN | PWM_CH2_PIN, .portc = PWM_CH0_PIN                                  },  // Channels 0-2
+    { .portc = PWM_CH3_PIN | PWM_CH4_PIN | PWM_CH5_PIN                                          },  // Channels 3-5
+    { .porta = PWM_CH7_PIN, .portc = PWM_CH6_PIN | PWM_CH8_PIN                                  },  // Channels 6-8
+    { .portd = PWM_CH9_PIN | PWM_CH10_PIN | PWM_CH11_PIN                                        },  // Channels 9-11
+    { .porta = PWM_CH13_PIN, .portc = PWM_CH14_PIN, .portd = PWM_CH12_PIN                       },  // Channels 12-14
+    { .portc = PWM_CH15_PIN | PWM_CH16_PIN | PWM_CH17_PIN                                       }   // Channels 15-17
+};
+
+
 static volatile uint32_t pwm_channel_ticks[18] = { 0 };
 static volatile pwm_update_state_t pwm_update_state = PWM_UPDATE_DISABLE;
+static volatile bool is_pwm_frozen = false;                // Pulse width update disabled until reset
+static volatile uint32_t pwm_stagger_step_us = 0;
+static uint32_t pwm_stagger_request_us = 0;
+static volatile uint32_t pwm_pending_frequency = 0;     // Frame rate for next frame, 0 - no change
+static pwm_pins_t slot_pins[PWM_SLOT_COUNT] = { 0 };
+static uint32_t density_bin_ticks = 1;
+static uint8_t  density_bins[PWM_DENSITY_BIN_COUNT] = { 0 };
 volatile uint32_t synchro = 0;
+uint16_t pwm_frequency = PWM_DEFAULT_FREQUENCY_HZ;    // Read only
+
+volatile uint8_t pwm_isr_density_peak = 0;    // Read only
+volatile uint8_t pwm_isr_density_max = 0;     // Read only
+
+
+#ifdef PWM_ISR_STATISTIC_ENABLE
+pwm_isr_statistic_t pwm_isr_statistic[PWM_ISR_COUNT] = { 0 };    // Read only
+static uint32_t isr_prev_latency[PWM_ISR_COUNT] = { 0 };
+static uint32_t isr_prev_synchro[PWM_ISR_COUNT] = { 0 };
+
+#define ISR_STATISTIC_ENTRY(_timer)         TcChannel* isr_timer = (_timer);             \
+                                            uint32_t isr_entry_cycles = DWT->CYCCNT;     \
+                                            uint32_t isr_entry_ticks = isr_timer->TC_CV
+#define ISR_STATISTIC_EXIT(_isr, _status)   update_isr_statistic((_isr), isr_timer, (_status), isr_entry_cycles, isr_entry_ticks)
+#else
+#define ISR_STATISTIC_ENTRY(_timer)
+#define ISR_STATISTIC_EXIT(_isr, _status)
+#endif
+
+
+static void apply_pending_frequency(void);
+static void start_slot_groups(uint32_t slot);
+static void count_isr_density(void);
+#ifdef PWM_ISR_STATISTIC_ENABLE
+static void update_isr_statistic(uint32_t isr, TcChannel* timer, uint32_t status, uint32_t entry_cycles, uint32_t entry_ticks);
+#endif
 
 
 //  ***************************************************************************
@@ -86,6 +153,18 @@ void pwm_init(void) {
         pwm_channel_ticks[i] = PWM_DISABLE_CHANNEL_VALUE;
     }        
     
+    // Initialize pulse start slots (group N starts in slot N % PWM_SLOT_COUNT)
+    for (uint32_t i = 0; i < PWM_GROUP_COUNT; ++i) {
+        slot_pins[i % PWM_SLOT_COUNT].porta |= group_pins[i].porta;
+        slot_pins[i % PWM_SLOT_COUNT].portb |= group_pins[i].portb;
+        slot_pins[i % PWM_SLOT_COUNT].portc |= group_pins[i].portc;
+        slot_pins[i % PWM_SLOT_COUNT].portd |= group_pins[i].portd;
+    }
+    pwm_set_pulse_stagger(0);
+    
+    // Initialize ISR density statistic
+    density_bin_ticks = PWM_PERIOD_TICKS / PWM_DENSITY_BIN_COUNT;
+    
     // Enable timers IRQ
     NVIC_EnableIRQ(TC0_IRQn);
     NVIC_EnableIRQ(TC3_IRQn);
@@ -104,11 +183,14 @@ void pwm_init(void) {
 //  ***************************************************************************
 void pwm_enable(void) {
 
+    // Sync timer stopped - new frame rate can be applied now
+    apply_pending_frequency();
+
     // Enable sync timer (PWM period)
     REG_TC0_CCR0 = TC_CCR_SWTRG | TC_CCR_CLKEN;
     
     // Allow pulse width update
-    pwm_update_state = PWM_UPDATE_ENABLE;
+    pwm_set_update_state(PWM_UPDATE_ENABLE);
 }
 
 //  ***************************************************************************
@@ -132,12 +214,31 @@ void pwm_disable(void) {
 
 //  ***************************************************************************
 /// @brief  Set pulse width update state
+/// @note   Check and write are done with IRQs masked, so freeze from ISR
+///         can't be lost between them
 /// @param  state: new PWM update state 
 /// @return none
 //  ***************************************************************************
 void pwm_set_update_state(pwm_update_state_t state) {
     
-    pwm_update_state = state;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (is_pwm_frozen == false) {
+        pwm_update_state = state;
+    }
+    __set_PRIMASK(primask);
+}
+
+//  ***************************************************************************
+/// @brief  Freeze PWM outputs at current pulse widths
+/// @note   Can be called from ISR. Pulse width update can't be enabled until reset
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void pwm_freeze(void) {
+    
+    is_pwm_frozen = true;
+    pwm_update_state = PWM_UPDATE_DISABLE;
 }
     
 //  ***************************************************************************
@@ -151,6 +252,59 @@ void pwm_set_width(uint32_t ch, uint32_t width) {
     pwm_channel_ticks[ch] = US_TO_TICKS(width);
 }
 
+//  ***************************************************************************
+/// @brief  Set PWM frame rate
+/// @note   New frame period apply on next frame start (sync timer RC compare).
+///         Pulse start stagger step recalculate for new frame period
+/// @param  frequency_hz: frame rate [Hz]
+/// @return true - frame rate changed, false - frame rate not supported
+//  ***************************************************************************
+bool pwm_set_frequency(uint32_t frequency_hz) {
+    
+    if (frequency_hz < PWM_MIN_FREQUENCY_HZ || frequency_hz > PWM_MAX_FREQUENCY_HZ) {
+        return false;
+    }
+    
+    pwm_pending_frequency = frequency_hz;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Get PWM frame rate
+/// @param  none
+/// @return frame rate [Hz]
+//  ***************************************************************************
+uint32_t pwm_get_frequency(void) {
+    
+    return pwm_frequency;
+}
+
+//  ***************************************************************************
+/// @brief  Set pulse start stagger between channel groups
+/// @note   Groups start in 3 slots: 0, step and 2 * step from frame start.
+///         Step is limited so the last slot pulse ends inside the frame
+/// @param  step_us: stagger step [us], 0 - all pulses start together
+/// @return none
+//  ***************************************************************************
+void pwm_set_pulse_stagger(uint32_t step_us) {
+    
+    pwm_stagger_request_us = step_us;
+    
+    uint32_t max_step_us = (PWM_PERIOD_US - PWM_MAX_PULSE_WIDTH_US) / (PWM_SLOT_COUNT - 1);
+    if (step_us > max_step_us) {
+        step_us = max_step_us;
+    }
+    
+    REG_TC0_IDR0 = TC_IDR_CPAS | TC_IDR_CPBS;
+    pwm_stagger_step_us = step_us;
+    
+    if (step_us != 0) {
+        REG_TC0_RA0  = US_TO_TICKS(step_us * 1);
+        REG_TC0_RB0  = US_TO_TICKS(step_us * 2);
+        REG_TC0_IER0 = TC_IER_CPAS | TC_IER_CPBS;
+    }
+}
+
 
 
 
@@ -161,49 +315,49 @@ void pwm_set_width(uint32_t ch, uint32_t width) {
 //  ***************************************************************************
 void TC0_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC0->TC_CHANNEL[0]);
     uint32_t status = REG_TC0_SR0;
 
     if (status & TC_SR_CPCS) {
         
         ++synchro;
         
-        // Connect all pins to VCC (reset state)
-        REG_PIOA_SODR = PWM_ALL_PINS_PORTA;
-        REG_PIOB_SODR = PWM_ALL_PINS_PORTB;
-        REG_PIOC_SODR = PWM_ALL_PINS_PORTC;
-        REG_PIOD_SODR = PWM_ALL_PINS_PORTD;
-
-        // Load pulse width to PWM channels
-        if (pwm_update_state == PWM_UPDATE_ENABLE) {
-            
-            REG_TC1_RA0 = pwm_channel_ticks[0];
-            REG_TC1_RB0 = pwm_channel_ticks[1];
-            REG_TC1_RC0 = pwm_channel_ticks[2];
-            REG_TC1_RA1 = pwm_channel_ticks[3];
-            REG_TC1_RB1 = pwm_channel_ticks[4];
-            REG_TC1_RC1 = pwm_channel_ticks[5];
-            REG_TC1_RA2 = pwm_channel_ticks[6];
-            REG_TC1_RB2 = pwm_channel_ticks[7];
-            REG_TC1_RC2 = pwm_channel_ticks[8];
-            REG_TC2_RA0 = pwm_channel_ticks[9];
-            REG_TC2_RB0 = pwm_channel_ticks[10];
-            REG_TC2_RC0 = pwm_channel_ticks[11];
-            REG_TC2_RA1 = pwm_channel_ticks[12];
-            REG_TC2_RB1 = pwm_channel_ticks[13];
-            REG_TC2_RC1 = pwm_channel_ticks[14];
-            REG_TC2_RA2 = pwm_channel_ticks[15];
-            REG_TC2_RB2 = pwm_channel_ticks[16];
-            REG_TC2_RC2 = pwm_channel_ticks[17];
-        }        
-
-        // Start PWM cycle
-        REG_TC1_CCR0 = TC_CCR_SWTRG | TC_CCR_CLKEN;
-        REG_TC1_CCR1 = TC_CCR_SWTRG | TC_CCR_CLKEN;
-        REG_TC1_CCR2 = TC_CCR_SWTRG | TC_CCR_CLKEN;
-        REG_TC2_CCR0 = TC_CCR_SWTRG | TC_CCR_CLKEN;
-        REG_TC2_CCR1 = TC_CCR_SWTRG | TC_CCR_CLKEN;
-        REG_TC2_CCR2 = TC_CCR_SWTRG | TC_CCR_CLKEN;
+        // Counter restarted from 0 - new frame period can be applied safely
+        apply_pending_frequency();
+        
+        // Update ISR density statistic for previous frame
+        uint8_t peak = 0;
+        for (uint32_t i = 0; i < PWM_DENSITY_BIN_COUNT; ++i) {
+            if (density_bins[i] > peak) {
+                peak = density_bins[i];
+            }
+            density_bins[i] = 0;
+        }
+        pwm_isr_density_peak = peak;
+        if (peak > pwm_isr_density_max) {
+            pwm_isr_density_max = peak;
+        }
+        
+        // Start first slot. If stagger disabled then start all slots together
+        start_slot_groups(0);
+        if (pwm_stagger_step_us == 0) {
+            start_slot_groups(1);
+            start_slot_groups(2);
+        }
+        
+        // Start control loop for next frame (PendSV)
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+    if (status & TC_SR_CPAS) {
+        start_slot_groups(1);
+        count_isr_density();
+    }
+    if (status & TC_SR_CPBS) {
+        start_slot_groups(2);
+        count_isr_density();
     }
+    
+    ISR_STATISTIC_EXIT(0, status);
 }
 
 //  ***************************************************************************
@@ -213,11 +367,15 @@ void TC0_Handler(void) {
 //  ***************************************************************************
 void TC3_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC1->TC_CHANNEL[0]);
     uint32_t status = REG_TC1_SR0;
 
     if (status & TC_SR_CPAS) { REG_PIOC_CODR = PWM_CH0_PIN; }
     if (status & TC_SR_CPBS) { REG_PIOB_CODR = PWM_CH1_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOB_CODR = PWM_CH2_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(1, status);
 }
 
 //  ***************************************************************************
@@ -227,11 +385,15 @@ void TC3_Handler(void) {
 //  ***************************************************************************
 void TC4_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC1->TC_CHANNEL[1]);
     uint32_t status = REG_TC1_SR1;
 
     if (status & TC_SR_CPAS) { REG_PIOC_CODR = PWM_CH3_PIN; }
     if (status & TC_SR_CPBS) { REG_PIOC_CODR = PWM_CH4_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOC_CODR = PWM_CH5_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(2, status);
 }
 
 //  ***************************************************************************
@@ -241,11 +403,15 @@ void TC4_Handler(void) {
 //  ***************************************************************************
 void TC5_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC1->TC_CHANNEL[2]);
     uint32_t status = REG_TC1_SR2;
 
     if (status & TC_SR_CPAS) { REG_PIOC_CODR = PWM_CH6_PIN; }
     if (status & TC_SR_CPBS) { REG_PIOA_CODR = PWM_CH7_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOC_CODR = PWM_CH8_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(3, status);
 }
 
 //  ***************************************************************************
@@ -255,11 +421,15 @@ void TC5_Handler(void) {
 //  ***************************************************************************
 void TC6_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC2->TC_CHANNEL[0]);
     uint32_t status = REG_TC2_SR0;
 
     if (status & TC_SR_CPAS) { REG_PIOD_CODR = PWM_CH9_PIN;  }
     if (status & TC_SR_CPBS) { REG_PIOD_CODR = PWM_CH10_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOD_CODR = PWM_CH11_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(4, status);
 }
 
 //  ***************************************************************************
@@ -269,11 +439,15 @@ void TC6_Handler(void) {
 //  ***************************************************************************
 void TC7_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC2->TC_CHANNEL[1]);
     uint32_t status = REG_TC2_SR1;
 
     if (status & TC_SR_CPAS) { REG_PIOD_CODR = PWM_CH12_PIN; }
     if (status & TC_SR_CPBS) { REG_PIOA_CODR = PWM_CH13_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOC_CODR = PWM_CH14_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(5, status);
 }
 
 //  ***************************************************************************
@@ -283,9 +457,146 @@ void TC7_Handler(void) {
 //  ***************************************************************************
 void TC8_Handler(void) {
 
+    ISR_STATISTIC_ENTRY(&TC2->TC_CHANNEL[2]);
     uint32_t status = REG_TC2_SR2;
-    
+
     if (status & TC_SR_CPAS) { REG_PIOC_CODR = PWM_CH15_PIN; }
     if (status & TC_SR_CPBS) { REG_PIOC_CODR = PWM_CH16_PIN; }
     if (status & TC_SR_CPCS) { REG_PIOC_CODR = PWM_CH17_PIN; }
+    
+    count_isr_density();
+    ISR_STATISTIC_EXIT(6, status);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Apply pending PWM frame rate
+/// @note   Call from sync timer ISR on frame start or when sync timer stopped
+/// @param  none
+/// @return none
+//  ***************************************************************************
+static void apply_pending_frequency(void) {
+    
+    if (pwm_pending_frequency == 0) {
+        return;
+    }
+    
+    pwm_frequency = pwm_pending_frequency;
+    pwm_pending_frequency = 0;
+    
+    REG_TC0_RC0 = PWM_PERIOD_TICKS;
+    density_bin_ticks = PWM_PERIOD_TICKS / PWM_DENSITY_BIN_COUNT;
+    pwm_set_pulse_stagger(pwm_stagger_request_us);
+}
+
+//  ***************************************************************************
+/// @brief  Start PWM cycle for slot channel groups
+/// @param  slot: pulse start slot index
+/// @return none
+//  ***************************************************************************
+static void start_slot_groups(uint32_t slot) {
+    
+    // Connect slot pins to VCC (reset state)
+    REG_PIOA_SODR = slot_pins[slot].porta;
+    REG_PIOB_SODR = slot_pins[slot].portb;
+    REG_PIOC_SODR = slot_pins[slot].portc;
+    REG_PIOD_SODR = slot_pins[slot].portd;
+    
+    for (uint32_t group = slot; group < PWM_GROUP_COUNT; group += PWM_SLOT_COUNT) {
+        
+        TcChannel* timer = group_timers[group];
+        
+        // Load pulse width to PWM channels
+        if (pwm_update_state == PWM_UPDATE_ENABLE) {
+            timer->TC_RA = pwm_channel_ticks[group * PWM_CHANNELS_PER_GROUP + 0];
+            timer->TC_RB = pwm_channel_ticks[group * PWM_CHANNELS_PER_GROUP + 1];
+            timer->TC_RC = pwm_channel_ticks[group * PWM_CHANNELS_PER_GROUP + 2];
+        }
+        
+        // Start PWM cycle
+        timer->TC_CCR = TC_CCR_SWTRG | TC_CCR_CLKEN;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Count PWM ISR entry in frame time bin
+/// @note   Call from PWM ISR only
+/// @return none
+//  ***************************************************************************
+static void count_isr_density(void) {
+    
+    uint32_t bin = REG_TC0_CV0 / density_bin_ticks;
+    if (bin >= PWM_DENSITY_BIN_COUNT) {
+        bin = PWM_DENSITY_BIN_COUNT - 1;
+    }
+    ++density_bins[bin];
+}
+
+
+#ifdef PWM_ISR_STATISTIC_ENABLE
+//  ***************************************************************************
+/// @brief  Update PWM ISR latency, duration and jitter statistic
+/// @note   Call from PWM ISR only. Latency measure from first matched compare
+///         to ISR entry. Jitter measure on first ISR entry in frame only
+/// @param  isr: ISR index (0 - sync timer, 1-6 - channels timers)
+/// @param  timer: ISR timer channel
+/// @param  status: timer status register value
+/// @param  entry_cycles: DWT cycle counter value on ISR entry
+/// @param  entry_ticks: timer counter value on ISR entry
+/// @return none
+//  ***************************************************************************
+static void update_isr_statistic(uint32_t isr, TcChannel* timer, uint32_t status, uint32_t entry_cycles, uint32_t entry_ticks) {
+    
+    pwm_isr_statistic_t* statistic = &pwm_isr_statistic[isr];
+    
+    // Find first matched compare. Sync timer counter reset on RC compare
+    uint32_t compare_ticks = 0xFFFFFFFF;
+    if ((status & TC_SR_CPAS) && timer->TC_RA < compare_ticks) {
+        compare_ticks = timer->TC_RA;
+    }
+    if ((status & TC_SR_CPBS) && timer->TC_RB < compare_ticks) {
+        compare_ticks = timer->TC_RB;
+    }
+    if (status & TC_SR_CPCS) {
+        uint32_t rc_ticks = (isr == 0) ? 0 : timer->TC_RC;
+        if (rc_ticks < compare_ticks) {
+            compare_ticks = rc_ticks;
+        }
+    }
+    
+    // Entry latency
+    uint32_t latency = (entry_ticks >= compare_ticks) ? TICKS_TO_CYCLES(entry_ticks - compare_ticks) : 0;
+    if (latency > statistic->latency_max) {
+        statistic->latency_max = (latency > 0xFFFF) ? 0xFFFF : latency;
+    }
+    
+    // Frame-to-frame jitter
+    if (isr_prev_synchro[isr] != synchro) {
+        
+        uint32_t jitter = (latency > isr_prev_latency[isr]) ? latency - isr_prev_latency[isr] : isr_prev_latency[isr] - latency;
+        if (jitter > statistic->jitter_max) {
+            statistic->jitter_max = (jitter > 0xFFFF) ? 0xFFFF : jitter;
+        }
+        
+        uint32_t bin = PWM_ISR_JITTER_HIST_SIZE - 1;
+        if      (jitter < US_TO_CYCLES(1))  bin = 0;
+        else if (jitter < US_TO_CYCLES(5))  bin = 1;
+        else if (jitter < US_TO_CYCLES(20)) bin = 2;
+        if (statistic->jitter_hist[bin] != 0xFFFF) {
+            ++statistic->jitter_hist[bin];
+        }
+        
+        isr_prev_latency[isr] = latency;
+        isr_prev_synchro[isr] = synchro;
+    }
+    
+    // Execution time
+    uint32_t duration = DWT->CYCCNT - entry_cycles;
+    if (duration > statistic->duration_max) {
+        statistic->duration_max = (duration > 0xFFFF) ? 0xFFFF : duration;
+    }
 }
+#endif
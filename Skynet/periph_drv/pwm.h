@@ -7,7 +7,19 @@
 #define PWM_H_
 
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define PWM_DISABLE_CHANNEL_VALUE            (0x0000)
+#define PWM_DEFAULT_FREQUENCY_HZ             (150)
+#define PWM_MIN_FREQUENCY_HZ                 (50)
+#define PWM_MAX_FREQUENCY_HZ                 (333)
+
+// Comment this line for remove PWM ISR latency and jitter statistic
+#define PWM_ISR_STATISTIC_ENABLE
+
+#define PWM_ISR_COUNT                        (7)        // TC0 (sync), TC3-TC8 (channels)
+#define PWM_ISR_JITTER_HIST_SIZE             (4)        // < 1us, < 5us, < 20us, >= 20us
 
 
 typedef enum {
@@ -15,15 +27,32 @@ typedef enum {
     PWM_UPDATE_ENABLE
 } pwm_update_state_t;
 
+typedef struct {
+    uint16_t latency_max;                               // Max ISR entry latency from timer compare [cycles]
+    uint16_t duration_max;                              // Max ISR execution time [cycles]
+    uint16_t jitter_max;                                // Max frame-to-frame entry latency change [cycles]
+    uint16_t jitter_hist[PWM_ISR_JITTER_HIST_SIZE];     // Frame-to-frame entry latency change histogram
+} pwm_isr_statistic_t;
+
 
 extern volatile uint32_t synchro;
+extern uint16_t          pwm_frequency;          // Current PWM frame rate [Hz]
+extern volatile uint8_t  pwm_isr_density_peak;   // PWM ISR count in busiest 1/32 frame window of last frame
+extern volatile uint8_t  pwm_isr_density_max;    // PWM ISR count in busiest 1/32 frame window since startup
+#ifdef PWM_ISR_STATISTIC_ENABLE
+extern pwm_isr_statistic_t pwm_isr_statistic[PWM_ISR_COUNT];    // Read only
+#endif
 
 
 extern void pwm_init(void);
 extern void pwm_enable(void);
 extern void pwm_disable(void);
 extern void pwm_set_update_state(pwm_update_state_t state);
+extern void pwm_freeze(void);
 extern void pwm_set_width(uint32_t ch, uint32_t width);
+extern void pwm_set_pulse_stagger(uint32_t step_us);
+extern bool pwm_set_frequency(uint32_t frequency_hz);
+extern uint32_t pwm_get_frequency(void);
 
 
 #endif // PWM_H_
\ No newline at end of file
@@ -19,6 +19,25 @@ void systimer_init(void) {
     if (SysTick_Config(SystemCoreClock / 1000)) { 
         while (1);
     }
+    
+    // SysTick_Config() set lowest priority. System time should not stall
+    // while control loop (PendSV) running or locked
+    NVIC_SetPriority(SysTick_IRQn, 0);
+    
+    // Enable DWT cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+//  ***************************************************************************
+/// @brief  Get current time in CPU cycles
+/// @note   Counter overflow every 51 seconds (84MHz)
+/// @param  none
+/// @return CPU cycles
+//  ***************************************************************************
+uint32_t get_time_cycles(void) {
+    return DWT->CYCCNT;
 }
 
 //  ***************************************************************************
@@ -10,6 +10,7 @@
 extern void systimer_init(void);
 extern uint32_t get_time_ms(void);
 extern uint32_t get_time_us(void);
+extern uint32_t get_time_cycles(void);
 extern void delay_ms(uint32_t ms);
 
 
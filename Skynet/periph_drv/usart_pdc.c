@@ -0,0 +1,642 @@
+//  ***************************************************************************
+/// @file    usart_pdc.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include <sam.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "usart_pdc.h"
+#include "systimer.h"
+#include "emergency_stop.h"
+
+
+typedef struct {
+    Usart*    usart;
+    IRQn_Type irq;
+    uint32_t  pmc_mask;
+    Pio*      pio;
+    uint32_t  tx_pin;
+    uint32_t  rx_pin;
+    bool      is_peripheral_b;                      // Pins function: false - A peripheral, true - B peripheral
+} instance_info_t;
+
+
+static const instance_info_t instances[USART_PDC_INSTANCE_COUNT] = {
+
+    [USART_PDC_USART0] = {
+        .usart = USART0,
+        .irq = USART0_IRQn,
+        .pmc_mask = PMC_PCER0_PID17,
+        .pio = PIOA,
+        .tx_pin = PIO_PA11,
+        .rx_pin = PIO_PA10,
+        .is_peripheral_b = false
+    },
+    [USART_PDC_USART1] = {
+        .usart = USART1,
+        .irq = USART1_IRQn,
+        .pmc_mask = PMC_PCER0_PID18,
+        .pio = PIOA,
+        .tx_pin = PIO_PA13,
+        .rx_pin = PIO_PA12,
+        .is_peripheral_b = false
+    },
+    [USART_PDC_USART3] = {
+        .usart = USART3,
+        .irq = USART3_IRQn,
+        .pmc_mask = PMC_PCER0_PID20,
+        .pio = PIOD,
+        .tx_pin = PIO_PD4,
+        .rx_pin = PIO_PD5,
+        .is_peripheral_b = true
+    }
+};
+
+static usart_pdc_t* ports[USART_PDC_INSTANCE_COUNT] = { NULL };     // Ports for ISR
+
+
+static uint32_t calculate_baud_rate_divider(uint32_t baud_rate, float* baud_rate_error);
+static uint32_t get_rx_position(usart_pdc_t* port);
+static void     read_ring(const usart_pdc_t* port, uint32_t position, uint8_t* buffer, uint32_t bytes_count);
+static void     complete_rx_frame(usart_pdc_t* port);
+static void     usart_pdc_handler(usart_pdc_t* port);
+
+
+//  ***************************************************************************
+/// @brief    Initialization USART
+/// @note     Mode 8N1. Port configuration fields should be filled
+/// @param    port: USART port descriptor
+/// @param    baud_rate: USART baud rate
+//  ***************************************************************************
+void usart_pdc_init(usart_pdc_t* port, uint32_t baud_rate) {
+
+    const instance_info_t* info = &instances[port->instance];
+    Usart* usart = info->usart;
+    ports[port->instance] = port;
+
+    // Enable clock
+    REG_PMC_PCER0 = info->pmc_mask;
+    while ((REG_PMC_PCSR0 & info->pmc_mask) == 0);
+
+    // Configure TX as output without pull-up
+    info->pio->PIO_PER  = info->tx_pin;
+    info->pio->PIO_OER  = info->tx_pin;
+    info->pio->PIO_PUDR = info->tx_pin;
+    info->pio->PIO_PDR  = info->tx_pin;
+
+    // Configure RX as input with pull-up
+    info->pio->PIO_PER  = info->rx_pin;
+    info->pio->PIO_ODR  = info->rx_pin;
+    info->pio->PIO_PUER = info->rx_pin;
+    info->pio->PIO_PDR  = info->rx_pin;
+
+    // Select peripheral function
+    if (info->is_peripheral_b == true) {
+        info->pio->PIO_ABSR |= info->tx_pin | info->rx_pin;
+    }
+    else {
+        info->pio->PIO_ABSR &= ~(info->tx_pin | info->rx_pin);
+    }
+
+    // Disable PDC channels and reset TX and RX
+    usart->US_PTCR = US_PTCR_TXTDIS | US_PTCR_RXTDIS;
+    usart->US_CR = US_CR_RSTTX | US_CR_RSTRX | US_CR_RSTSTA;
+
+    // Configure 8N1 mode
+    usart->US_MR = US_MR_CHRL_8_BIT | US_MR_PAR_NO | US_MR_NBSTOP_1_BIT | US_MR_USART_MODE_NORMAL | US_MR_USCLKS_MCK | US_MR_CHMODE_NORMAL;
+
+    // Disable all interrupts
+    usart->US_IDR = 0xFFFFFFFF;
+    NVIC_EnableIRQ(info->irq);
+
+    // Configure PDC channels
+    port->tx_fill_buffer = 0;
+    usart->US_TCR = 0;
+    usart->US_TNCR = 0;
+    usart->US_TPR = (uint32_t)port->tx_buffer;
+    usart->US_RCR = 0;
+    usart->US_RNCR = 0;
+    usart->US_RPR = (uint32_t)port->rx_buffer;
+
+    // Configure baud rate
+    usart_pdc_set_baud_rate(port, baud_rate);
+}
+
+//  ***************************************************************************
+/// @brief    Set USART baud rate
+/// @note     Frame timeout recalculated for new baud rate, it is not less
+///           than port rx_timeout_min
+/// @param    port: USART port descriptor
+/// @param    baud_rate: USART baud rate
+//  ***************************************************************************
+void usart_pdc_set_baud_rate(usart_pdc_t* port, uint32_t baud_rate) {
+
+    Usart* usart = instances[port->instance].usart;
+
+    // Disable PDC channels and reset TX and RX
+    usart->US_PTCR = US_PTCR_TXTDIS | US_PTCR_RXTDIS;
+    usart->US_CR = US_CR_RSTTX | US_CR_RSTRX | US_CR_RSTSTA;
+
+    // Configure baud rate
+    float error = 0;
+    usart->US_BRGR = calculate_baud_rate_divider(baud_rate, &error);
+
+    // Configure frame timeout
+    uint32_t rx_timeout_periods = (uint32_t)(((uint64_t)port->rx_timeout_min * baud_rate + 999999) / 1000000);
+    if (rx_timeout_periods < port->rx_timeout) {
+        rx_timeout_periods = port->rx_timeout;
+    }
+    if (rx_timeout_periods > US_RTOR_TO_Msk) {
+        rx_timeout_periods = US_RTOR_TO_Msk;
+    }
+    port->rx_timeout_periods = rx_timeout_periods;
+    usart->US_RTOR = rx_timeout_periods;
+
+    // Enable TX and RX
+    usart->US_CR = US_CR_TXEN | US_CR_RXEN;
+}
+
+//  ***************************************************************************
+/// @brief    Check baud rate can be set with acceptable error
+/// @note     Error of nearest divider should not exceed
+///           USART_PDC_MAX_BAUD_RATE_ERROR
+/// @param    baud_rate: USART baud rate
+/// @return   true - baud rate supported, false - no
+//  ***************************************************************************
+bool usart_pdc_is_baud_rate_supported(uint32_t baud_rate) {
+
+    if (baud_rate == 0 || baud_rate > SystemCoreClock / 16) {
+        return false;
+    }
+
+    float error = 0;
+    calculate_baud_rate_divider(baud_rate, &error);
+    return error <= USART_PDC_MAX_BAUD_RATE_ERROR;
+}
+
+//  ***************************************************************************
+/// @brief    Check USART errors
+/// @note     Check overrun error, framing error, parity error and RX ring
+///           overflow. Need reset USART
+/// @param    port: USART port descriptor
+/// @return   true - error, false - no errors
+//  ***************************************************************************
+bool usart_pdc_is_error(const usart_pdc_t* port) {
+    uint32_t reg = instances[port->instance].usart->US_CSR;
+    return (reg & (US_CSR_OVRE | US_CSR_FRAME | US_CSR_PARE)) || port->is_rx_overflow == true;
+}
+
+//  ***************************************************************************
+/// @brief    Reset USART
+/// @note     Reset status register, reset transmitter and receiver
+/// @param    port: USART port descriptor
+/// @param    is_reset_transmitter: true - reset transmitter
+/// @param    is_reset_receiver: true - reset receiver
+//  ***************************************************************************
+void usart_pdc_reset(usart_pdc_t* port, bool is_reset_transmitter, bool is_reset_receiver) {
+
+    Usart* usart = instances[port->instance].usart;
+
+    if (is_reset_transmitter == true) {
+
+        // Disable PDC channel and reset TX
+        usart->US_PTCR = US_PTCR_TXTDIS;
+        usart->US_CR = US_CR_RSTTX | US_CR_RSTSTA;
+
+        // Reset PDC channel
+        usart->US_TCR = 0;
+        usart->US_TNCR = 0;
+        usart->US_TPR = (uint32_t)port->tx_buffer;
+        port->tx_fill_buffer = 0;
+
+        // Enable TX
+        usart->US_CR = US_CR_TXEN;
+    }
+
+    if (is_reset_receiver == true) {
+
+        // Disable PDC channel and reset RX
+        usart->US_PTCR = US_PTCR_RXTDIS;
+        usart->US_CR = US_CR_RSTRX | US_CR_RSTSTA;
+
+        // Disable all interrupts
+        usart->US_IDR = 0xFFFFFFFF;
+
+        // Reset PDC channel and frame queue
+        usart->US_RCR = 0;
+        usart->US_RNCR = 0;
+        usart->US_RPR = (uint32_t)port->rx_buffer;
+        port->rx_head = 0;
+        port->rx_count = 0;
+        port->is_rx_overflow = false;
+
+        // Enable RX
+        usart->US_CR = US_CR_RXEN;
+    }
+}
+
+//  ***************************************************************************
+/// @brief    Start asynchronous transmit of filled TX buffer
+/// @note     If previous transmit in progress then buffer queued to PDC next
+///           pointer and start transmit automatically. After call application
+///           get next TX buffer (ping-pong buffers)
+/// @param    port: USART port descriptor
+/// @param    bytes_count: bytes count for transmit
+//  ***************************************************************************
+void usart_pdc_start_tx(usart_pdc_t* port, uint32_t bytes_count) {
+
+    Usart* usart = instances[port->instance].usart;
+
+    if (bytes_count > port->tx_buffer_size) {
+        bytes_count = port->tx_buffer_size;
+    }
+
+    // Initialize DMA for transfer
+    usart->US_PTCR = US_PTCR_TXTDIS;
+    if (usart->US_TCR == 0) {
+        usart->US_TPR = (uint32_t)usart_pdc_get_tx_buffer(port);
+        usart->US_TCR = bytes_count;
+    }
+    else {
+        usart->US_TNPR = (uint32_t)usart_pdc_get_tx_buffer(port);
+        usart->US_TNCR = bytes_count;
+    }
+    usart->US_PTCR = US_PTCR_TXTEN;
+
+    // Swap buffers
+    port->tx_fill_buffer = (port->tx_fill_buffer + 1) % port->tx_buffer_count;
+}
+
+//  ***************************************************************************
+/// @brief    Check transmit complete
+/// @param    port: USART port descriptor
+/// @return   true - transmit complete, false - no
+//  ***************************************************************************
+bool usart_pdc_is_tx_complete(const usart_pdc_t* port) {
+    uint32_t reg = instances[port->instance].usart->US_CSR;
+    return (reg & US_CSR_TXEMPTY);
+}
+
+//  ***************************************************************************
+/// @brief    Check TX buffer available for fill
+/// @note     Ping-pong buffer is busy while it queued to PDC next pointer,
+///           single buffer is busy while it transmitting
+/// @param    port: USART port descriptor
+/// @return   true - buffer available, false - no
+//  ***************************************************************************
+bool usart_pdc_is_tx_buffer_available(const usart_pdc_t* port) {
+
+    Usart* usart = instances[port->instance].usart;
+    if (port->tx_buffer_count > 1) {
+        return usart->US_TNCR == 0;
+    }
+    return usart->US_TCR == 0;
+}
+
+//  ***************************************************************************
+/// @brief    Get TX buffer address for fill
+/// @note     Address changes after each usart_pdc_start_tx() call if port
+///           have ping-pong buffers
+/// @param    port: USART port descriptor
+/// @return   Buffer address
+//  ***************************************************************************
+uint8_t* usart_pdc_get_tx_buffer(const usart_pdc_t* port) {
+    return &port->tx_buffer[port->tx_fill_buffer * port->tx_buffer_size];
+}
+
+
+
+//  ***************************************************************************
+/// @brief    Start continuous receive to ring buffer
+/// @note     PDC next pointer always point to ring start and reloaded after
+///           ring end reached. Frame is complete when frame timeout detected
+/// @param    port: USART port descriptor
+//  ***************************************************************************
+void usart_pdc_start_rx(usart_pdc_t* port) {
+
+    Usart* usart = instances[port->instance].usart;
+
+    // Disable DMA and IRQ
+    usart->US_PTCR = US_PTCR_RXTDIS;
+    usart->US_IDR = US_IDR_TIMEOUT | US_IDR_ENDRX;
+
+    // Reset ring and frame queue
+    port->rx_ring_position = 0;
+    port->rx_frame_position = 0;
+    port->rx_head = 0;
+    port->rx_count = 0;
+    port->is_rx_overflow = false;
+
+    // Initialize frame timeout
+    usart->US_RTOR = port->rx_timeout_periods;
+    usart->US_CR = US_CR_STTTO;
+
+    // Initialize DMA for receive: ring - current and next buffer
+    usart->US_RPR = (uint32_t)port->rx_buffer;
+    usart->US_RCR = port->rx_buffer_size;
+    usart->US_RNPR = (uint32_t)port->rx_buffer;
+    usart->US_RNCR = port->rx_buffer_size;
+    usart->US_IER = US_IER_TIMEOUT | US_IER_ENDRX;
+
+    // Enable DMA
+    usart->US_PTCR = US_PTCR_RXTEN;
+}
+
+//  ***************************************************************************
+/// @brief    Check first frame in queue receive complete
+/// @param    port: USART port descriptor
+/// @return   true - frame received, false - no
+//  ***************************************************************************
+bool usart_pdc_is_frame_received(const usart_pdc_t* port) {
+    return port->rx_count != 0;
+}
+
+//  ***************************************************************************
+/// @brief    Get first frame in queue size
+/// @note     Return received bytes count if frame receive is not complete
+/// @param    port: USART port descriptor
+/// @return   Frame size
+//  ***************************************************************************
+uint32_t usart_pdc_get_frame_size(usart_pdc_t* port) {
+
+    IRQn_Type irq = instances[port->instance].irq;
+
+    NVIC_DisableIRQ(irq);
+    uint32_t size = 0;
+    if (port->rx_count != 0) {
+        size = port->rx_frames[port->rx_head].size;
+    }
+    else {
+        size = get_rx_position(port) - port->rx_frame_position;
+    }
+    NVIC_EnableIRQ(irq);
+
+    return size;
+}
+
+//  ***************************************************************************
+/// @brief    Get first frame in queue receive complete time
+/// @param    port: USART port descriptor
+/// @return   Time [us]
+//  ***************************************************************************
+uint32_t usart_pdc_get_frame_time(const usart_pdc_t* port) {
+    return port->rx_frames[port->rx_head].time;
+}
+
+//  ***************************************************************************
+/// @brief    Read first frame in queue data from ring
+/// @note     Frame may be not complete. Caller should not read more bytes
+///           than usart_pdc_get_frame_size() return
+/// @param    port: USART port descriptor
+/// @param    offset: offset in frame
+/// @param    buffer: destination buffer
+/// @param    bytes_count: bytes count for read
+/// @return   true - success, false - data overwritten by receive (ring overflow)
+//  ***************************************************************************
+bool usart_pdc_read_frame(usart_pdc_t* port, uint32_t offset, uint8_t* buffer, uint32_t bytes_count) {
+
+    IRQn_Type irq = instances[port->instance].irq;
+
+    NVIC_DisableIRQ(irq);
+    uint32_t position = (port->rx_count != 0) ? port->rx_frames[port->rx_head].position : port->rx_frame_position;
+    NVIC_EnableIRQ(irq);
+
+    read_ring(port, position + offset, buffer, bytes_count);
+
+    // Check frame is not overwritten while read
+    return usart_pdc_is_frame_valid(port);
+}
+
+//  ***************************************************************************
+/// @brief    Get first frame in queue data chunk in RX ring without copy
+/// @note     Chunk is limited by ring end, call again for rest of data.
+///           Frame may be not complete. Caller should not request more
+///           bytes than usart_pdc_get_frame_size() return
+/// @param    port: USART port descriptor
+/// @param    offset: offset in frame
+/// @param    bytes_count: requested bytes count
+/// @param    chunk: chunk address in RX ring
+/// @return   Chunk size
+//  ***************************************************************************
+uint32_t usart_pdc_get_frame_chunk(usart_pdc_t* port, uint32_t offset, uint32_t bytes_count, const uint8_t** chunk) {
+
+    IRQn_Type irq = instances[port->instance].irq;
+
+    NVIC_DisableIRQ(irq);
+    uint32_t position = (port->rx_count != 0) ? port->rx_frames[port->rx_head].position : port->rx_frame_position;
+    NVIC_EnableIRQ(irq);
+
+    uint32_t index = (position + offset) & (port->rx_buffer_size - 1);
+    if (bytes_count > port->rx_buffer_size - index) {
+        bytes_count = port->rx_buffer_size - index;
+    }
+    *chunk = &port->rx_buffer[index];
+    return bytes_count;
+}
+
+//  ***************************************************************************
+/// @brief    Get first frame in queue address
+/// @note     Frame is accessed in place in RX ring. Only frame wrapped around
+///           ring end is copied to wrap buffer. Frame is valid until
+///           usart_pdc_release_frame() call or until ring overflow
+/// @param    port: USART port descriptor
+/// @param    wrap_buffer: buffer for wrapped frame (frame size bytes)
+/// @return   Frame address or NULL if no frame or frame overwritten
+//  ***************************************************************************
+const uint8_t* usart_pdc_get_frame(usart_pdc_t* port, uint8_t* wrap_buffer) {
+
+    if (port->rx_count == 0) {
+        return NULL;
+    }
+
+    const usart_pdc_frame_t* frame = &port->rx_frames[port->rx_head];
+    uint32_t index = frame->position & (port->rx_buffer_size - 1);
+    if (index + frame->size > port->rx_buffer_size) {
+        return (usart_pdc_read_frame(port, 0, wrap_buffer, frame->size) == true) ? wrap_buffer : NULL;
+    }
+    return (usart_pdc_is_frame_valid(port) == true) ? &port->rx_buffer[index] : NULL;
+}
+
+//  ***************************************************************************
+/// @brief    Check first frame in queue is not overwritten in RX ring
+/// @note     Call after in place frame processing
+/// @param    port: USART port descriptor
+/// @return   true - frame valid, false - frame overwritten by receive
+//  ***************************************************************************
+bool usart_pdc_is_frame_valid(usart_pdc_t* port) {
+
+    IRQn_Type irq = instances[port->instance].irq;
+
+    NVIC_DisableIRQ(irq);
+    uint32_t position = (port->rx_count != 0) ? port->rx_frames[port->rx_head].position : port->rx_frame_position;
+    bool is_valid = (get_rx_position(port) - position <= port->rx_buffer_size);
+    NVIC_EnableIRQ(irq);
+
+    return is_valid;
+}
+
+//  ***************************************************************************
+/// @brief    Remove first frame from queue
+/// @param    port: USART port descriptor
+//  ***************************************************************************
+void usart_pdc_release_frame(usart_pdc_t* port) {
+
+    IRQn_Type irq = instances[port->instance].irq;
+
+    NVIC_DisableIRQ(irq);
+    if (port->rx_count != 0) {
+        port->rx_head = (port->rx_head + 1) % USART_PDC_RX_QUEUE_SIZE;
+        --port->rx_count;
+    }
+    NVIC_EnableIRQ(irq);
+}
+
+
+
+//  ***************************************************************************
+/// @brief    Calculate baud rate divider with fractional part
+/// @param    baud_rate: USART baud rate
+/// @param    baud_rate_error: actual baud rate error of divider [%]
+/// @return   US_BRGR register value
+//  ***************************************************************************
+static uint32_t calculate_baud_rate_divider(uint32_t baud_rate, float* baud_rate_error) {
+
+    uint32_t CD = (SystemCoreClock / baud_rate) / 16;
+    uint8_t best_FP = 0;
+    float best_error = 100;
+    for (uint8_t FP = 0; FP < 8; ++FP) {
+
+        float actual_baud_rate = SystemCoreClock / (16.0 * (CD + FP / 8.0));
+        float error = (1.0 - baud_rate / actual_baud_rate) * 100.0;
+        if (error < 0) {
+            error *= -1;
+        }
+
+        if (error < best_error) {
+            best_error = error;
+            best_FP = FP;
+        }
+    }
+
+    *baud_rate_error = best_error;
+    return (best_FP << 16) | CD;
+}
+
+//  ***************************************************************************
+/// @brief    Get receive position in received bytes stream
+/// @note     Call with port IRQ disabled or from ISR. Ring end processed here
+///           if ENDRX is not processed yet: PDC already loaded next pointer
+/// @param    port: USART port descriptor
+/// @return   Position
+//  ***************************************************************************
+static uint32_t get_rx_position(usart_pdc_t* port) {
+
+    Usart* usart = instances[port->instance].usart;
+
+    uint32_t counter = usart->US_RCR;
+    if (usart->US_CSR & US_CSR_ENDRX) {
+
+        // Ring end reached - reload next pointer to ring start (clear ENDRX)
+        port->rx_ring_position += port->rx_buffer_size;
+        usart->US_RNPR = (uint32_t)port->rx_buffer;
+        usart->US_RNCR = port->rx_buffer_size;
+        counter = usart->US_RCR;
+    }
+    uint32_t position = port->rx_ring_position + port->rx_buffer_size - counter;
+
+    // Check oldest not released data is not overwritten
+    uint32_t oldest = (port->rx_count != 0) ? port->rx_frames[port->rx_head].position : port->rx_frame_position;
+    if (position - oldest > port->rx_buffer_size) {
+        port->is_rx_overflow = true;
+    }
+    return position;
+}
+
+//  ***************************************************************************
+/// @brief    Read data from ring
+/// @param    port: USART port descriptor
+/// @param    position: position in received bytes stream
+/// @param    buffer: destination buffer
+/// @param    bytes_count: bytes count for read
+//  ***************************************************************************
+static void read_ring(const usart_pdc_t* port, uint32_t position, uint8_t* buffer, uint32_t bytes_count) {
+
+    uint32_t index = position & (port->rx_buffer_size - 1);
+    uint32_t part_size = port->rx_buffer_size - index;
+    if (part_size > bytes_count) {
+        part_size = bytes_count;
+    }
+
+    memcpy(buffer, &port->rx_buffer[index], part_size);
+    memcpy(&buffer[part_size], port->rx_buffer, bytes_count - part_size);
+}
+
+//  ***************************************************************************
+/// @brief    Complete receiving frame and push it to queue
+/// @note     Call from ISR only
+/// @param    port: USART port descriptor
+//  ***************************************************************************
+static void complete_rx_frame(usart_pdc_t* port) {
+
+    uint32_t position = get_rx_position(port);
+    uint32_t size = position - port->rx_frame_position;
+    if (size == 0) {
+        return;
+    }
+
+    // Emergency stop frame is checked without main loop delay
+    if (size == EMERGENCY_STOP_FRAME_SIZE) {
+        uint8_t frame[EMERGENCY_STOP_FRAME_SIZE];
+        read_ring(port, port->rx_frame_position, frame, size);
+        emergency_stop_check_frame(frame, size);
+    }
+
+    // Push frame to queue. Frame is dropped if queue is full
+    if (port->rx_count == USART_PDC_RX_QUEUE_SIZE) {
+        port->is_rx_overflow = true;
+    }
+    else {
+        usart_pdc_frame_t* frame = &port->rx_frames[(port->rx_head + port->rx_count) % USART_PDC_RX_QUEUE_SIZE];
+        frame->position = port->rx_frame_position;
+        frame->size = size;
+        frame->time = get_time_us();
+        ++port->rx_count;
+    }
+    port->rx_frame_position = position;
+}
+
+//  ***************************************************************************
+/// @brief    USART ISR
+/// @note     ENDRX - ring end reached, PDC continue receive from ring start
+///           TIMEOUT - frame received
+/// @param    port: USART port descriptor
+//  ***************************************************************************
+static void usart_pdc_handler(usart_pdc_t* port) {
+
+    Usart* usart = instances[port->instance].usart;
+    uint32_t status = usart->US_CSR & usart->US_IMR;
+
+    if (status & US_CSR_ENDRX) {
+        get_rx_position(port);
+    }
+
+    if (status & US_CSR_TIMEOUT) {
+
+        // Restart frame timeout (wait next character)
+        usart->US_CR = US_CR_STTTO;
+        complete_rx_frame(port);
+    }
+}
+
+void USART0_Handler(void) {
+    usart_pdc_handler(ports[USART_PDC_USART0]);
+}
+
+void USART1_Handler(void) {
+    usart_pdc_handler(ports[USART_PDC_USART1]);
+}
+
+void USART3_Handler(void) {
+    usart_pdc_handler(ports[USART_PDC_USART3]);
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+//  ***************************************************************************
+/// @file    usart_pdc.h
+/// @author  NeoProg
+/// @brief   USART driver with PDC ring buffer receive
+//  ***************************************************************************
+#ifndef USART_PDC_H_
+#define USART_PDC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define USART_PDC_RX_QUEUE_SIZE               (4)       // Received frames queue size
+#define USART_PDC_MAX_BAUD_RATE_ERROR         (2.0)     // Max baud rate error of divider [%]
+
+
+typedef enum {
+    USART_PDC_USART0,
+    USART_PDC_USART1,
+    USART_PDC_USART3,
+    USART_PDC_INSTANCE_COUNT
+} usart_pdc_instance_t;
+
+typedef struct {
+    uint32_t position;                                  // Frame start position in received bytes stream
+    uint32_t size;
+    uint32_t time;                                      // Frame complete time [us]
+} usart_pdc_frame_t;
+
+// USART port descriptor. Configuration fields are filled by caller,
+// other fields are driver state
+typedef struct {
+    usart_pdc_instance_t instance;
+    uint8_t*             tx_buffer;                     // TX buffers (tx_buffer_count * tx_buffer_size bytes)
+    uint32_t             tx_buffer_size;
+    uint32_t             tx_buffer_count;               // 1 - single buffer, 2 - ping-pong buffers
+    uint8_t*             rx_buffer;                     // RX ring buffer
+    uint32_t             rx_buffer_size;                // Must be power of 2
+    uint32_t             rx_timeout;                    // Frame timeout [bit periods]
+    uint32_t             rx_timeout_min;                // Frame timeout lower limit [us], 0 - no limit
+
+    uint32_t             rx_timeout_periods;            // Frame timeout for current baud rate [bit periods]
+    uint32_t             tx_fill_buffer;                // TX buffer index for application
+    volatile uint32_t    rx_ring_position;              // Ring start position in received bytes stream
+    volatile uint32_t    rx_frame_position;             // Receiving frame start position
+    volatile bool        is_rx_overflow;                // Ring or frame queue overflow
+    usart_pdc_frame_t    rx_frames[USART_PDC_RX_QUEUE_SIZE];
+    volatile uint32_t    rx_head;                       // First frame for application
+    volatile uint32_t    rx_count;                      // Completed frames count
+} usart_pdc_t;
+
+
+void           usart_pdc_init(usart_pdc_t* port, uint32_t baud_rate);
+void           usart_pdc_set_baud_rate(usart_pdc_t* port, uint32_t baud_rate);
+bool           usart_pdc_is_baud_rate_supported(uint32_t baud_rate);
+void           usart_pdc_reset(usart_pdc_t* port, bool is_reset_transmitter, bool is_reset_receiver);
+bool           usart_pdc_is_error(const usart_pdc_t* port);
+
+void           usart_pdc_start_tx(usart_pdc_t* port, uint32_t bytes_count);
+bool           usart_pdc_is_tx_complete(const usart_pdc_t* port);
+bool           usart_pdc_is_tx_buffer_available(const usart_pdc_t* port);
+uint8_t*       usart_pdc_get_tx_buffer(const usart_pdc_t* port);
+
+void           usart_pdc_start_rx(usart_pdc_t* port);
+bool           usart_pdc_is_frame_received(const usart_pdc_t* port);
+uint32_t       usart_pdc_get_frame_size(usart_pdc_t* port);
+uint32_t       usart_pdc_get_frame_time(const usart_pdc_t* port);
+bool           usart_pdc_read_frame(usart_pdc_t* port, uint32_t offset, uint8_t* buffer, uint32_t bytes_count);
+uint32_t       usart_pdc_get_frame_chunk(usart_pdc_t* port, uint32_t offset, uint32_t bytes_count, const uint8_t** chunk);
+const uint8_t* usart_pdc_get_frame(usart_pdc_t* port, uint8_t* wrap_buffer);
+bool           usart_pdc_is_frame_valid(usart_pdc_t* port);
+void           usart_pdc_release_frame(usart_pdc_t* port);
+
+
+#endif // USART_PDC_H_
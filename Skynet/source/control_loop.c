@@ -0,0 +1,134 @@
+//  ***************************************************************************
+/// @file    control_loop.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "control_loop.h"
+
+#include <sam.h>
+#include <stdbool.h>
+#include "movement_engine.h"
+#include "limbs_driver.h"
+#include "servo_driver.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "systimer.h"
+#include "pwm.h"
+#include "teleop.h"
+#include "error_handling.h"
+
+#define CONTROL_LOOP_IRQ_PRIORITY           ((1 << __NVIC_PRIO_BITS) - 1)   // Lowest priority
+#define CONTROL_LOOP_LOCK_BASEPRI           (CONTROL_LOOP_IRQ_PRIORITY << (8 - __NVIC_PRIO_BITS))
+#define TIMER_TICKS_PER_US                  (SystemCoreClock / 2 / 1000000)
+#define CYCLES_PER_US                       (SystemCoreClock / 1000000)
+
+
+uint16_t control_loop_latency = 0;          // Read only
+uint16_t control_loop_latency_max = 0;      // Read only
+
+static bool     is_started = false;
+static uint32_t prev_frame = 0;
+static uint32_t lock_depth = 0;             // Nested locks count
+static uint32_t unlocked_basepri = 0;       // BASEPRI before first lock
+
+
+static void run_task(task_id_t id, void(*process)(void));
+
+
+//  ***************************************************************************
+/// @brief  Control loop initialization
+/// @note   Call after movement engine, limbs driver and servo driver init
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void control_loop_init(void) {
+    
+    NVIC_SetPriority(PendSV_IRQn, CONTROL_LOOP_IRQ_PRIORITY);
+    
+    prev_frame = synchro;
+    is_started = true;
+}
+
+//  ***************************************************************************
+/// @brief  Lock control loop
+/// @note   Call before access to control loop modules from background.
+///         Locks can be nested: BASEPRI restored by last unlock
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void control_loop_lock(void) {
+    
+    uint32_t basepri = __get_BASEPRI();
+    __set_BASEPRI(CONTROL_LOOP_LOCK_BASEPRI);
+    
+    if (lock_depth == 0) {
+        unlocked_basepri = basepri;
+    }
+    ++lock_depth;
+}
+
+//  ***************************************************************************
+/// @brief  Unlock control loop
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void control_loop_unlock(void) {
+    
+    if (lock_depth == 0) {
+        return;
+    }
+    
+    --lock_depth;
+    if (lock_depth == 0) {
+        __set_BASEPRI(unlocked_basepri);
+    }
+}
+
+
+
+//  ***************************************************************************
+/// @brief  Control loop ISR (PendSV)
+/// @note   Pended by PWM sync timer ISR on frame start. Control loop stopped
+///         in emergency mode
+/// @return none
+//  ***************************************************************************
+void PendSV_Handler(void) {
+    
+    if (is_started == false || callback_is_emergency_mode_active() == true) return;
+    
+    
+    uint32_t current_frame = synchro;
+    uint32_t missed_frame_count = (current_frame - prev_frame > 1) ? current_frame - prev_frame - 1 : 0;
+    prev_frame = current_frame;
+    
+    run_task(TASK_ID_MOVEMENT_ENGINE, movement_engine_process);
+    run_task(TASK_ID_LIMBS_DRIVER,    limbs_driver_process);
+    
+    // Servo pulse widths committed - calculate latency from frame start
+    uint32_t latency = (synchro - current_frame) * (1000000 / pwm_get_frequency()) + REG_TC0_CV0 / TIMER_TICKS_PER_US;
+    control_loop_latency = (latency > 0xFFFF) ? 0xFFFF : latency;
+    if (control_loop_latency > control_loop_latency_max) {
+        control_loop_latency_max = control_loop_latency;
+    }
+    
+    run_task(TASK_ID_SERVO_DRIVER,    servo_driver_process);
+    teleop_frame_committed();
+    
+    scheduler_frame_complete(missed_frame_count);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Run control loop task and update profiler statistic
+/// @param  id: task ID @ref task_id_t
+/// @param  process: task process function
+/// @return none
+//  ***************************************************************************
+static void run_task(task_id_t id, void(*process)(void)) {
+    
+    uint32_t start_cycles = get_time_cycles();
+    process();
+    profiler_task_complete(id, (get_time_cycles() - start_cycles) / CYCLES_PER_US);
+}
@@ -0,0 +1,47 @@
+//  ***************************************************************************
+/// @file    emergency_stop.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "emergency_stop.h"
+
+#include <sam.h>
+#include "pwm.h"
+
+
+// Reserved ModBus frame. CRC16 is constant - frame is compared without CRC calculation
+static const uint8_t emergency_stop_frame[EMERGENCY_STOP_FRAME_SIZE] = { 0xFE, 0x4D, 0x53, 0x54, 0x50, 0xD4, 0x55 };
+
+static volatile bool is_emergency_stop_active = false;
+
+
+//  ***************************************************************************
+/// @brief  Check received frame and freeze PWM if it is emergency stop frame
+/// @note   Call from USART ISR only on frame complete. PWM outputs keep current
+///         pulse widths, emergency mode is entered by main loop
+/// @param  frame: received frame
+/// @param  size: received frame size
+/// @return none
+//  ***************************************************************************
+void emergency_stop_check_frame(const uint8_t* frame, uint32_t size) {
+
+    if (size != EMERGENCY_STOP_FRAME_SIZE) {
+        return;
+    }
+    for (uint32_t i = 0; i < EMERGENCY_STOP_FRAME_SIZE; ++i) {
+        if (frame[i] != emergency_stop_frame[i]) {
+            return;
+        }
+    }
+
+    pwm_freeze();
+    is_emergency_stop_active = true;
+}
+
+//  ***************************************************************************
+/// @brief  Check emergency stop state
+/// @param  none
+/// @return true - emergency stop frame received, false - no
+//  ***************************************************************************
+bool emergency_stop_is_active(void) {
+    return is_emergency_stop_active;
+}
\ No newline at end of file
@@ -115,6 +115,13 @@ void callback_set_i2c_error(error_module_name_t module) {
     error_status |= (module | I2C_ERROR_MASK);
 }
 
+/// ***************************************************************************
+/// @brief  Callback function for set error - Emergency stop command
+//  ***************************************************************************
+void callback_set_emergency_stop(void) {
+    error_status |= (ERROR_MODULE_EMERGENCY_STOP | EMERGENCY_MODE_MASK);
+}
+
 
 
 /// ***************************************************************************
@@ -0,0 +1,47 @@
+//  ***************************************************************************
+/// @file    foot_target.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "foot_target.h"
+
+#include <sam.h>
+
+
+uint16_t foot_target_error_count = 0;       // Read only
+uint8_t  foot_target_error_mask = 0;        // Read only
+
+
+//  ***************************************************************************
+/// @brief  Decode foot targets frame and pass targets to limbs driver
+/// @note   Frame: [sequence][X, Y, Z (int16, mm) x 6], big-endian.
+///         Response: [sequence][error mask], error mask contain bit per limb
+///         with unreachable target or link angle out of range. Frame with
+///         bad targets is rejected, limbs stay in previous position
+/// @param  frame: pointer to frame
+/// @param  response: pointer to response buffer (FOOT_TARGET_RESPONSE_SIZE)
+/// @return true - frame processed, false - limbs driver busy by movement
+//  ***************************************************************************
+bool foot_target_process_frame(const uint8_t* frame, uint8_t* response) {
+
+    point_3d_t targets[SUPPORT_LIMB_COUNT];
+    const uint8_t* data = &frame[1];
+    for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i, data += 6) {
+        targets[i].x = (int16_t)((data[0] << 8) | data[1]);
+        targets[i].y = (int16_t)((data[2] << 8) | data[3]);
+        targets[i].z = (int16_t)((data[4] << 8) | data[5]);
+    }
+
+    uint8_t error_mask = 0;
+    if (limbs_driver_set_foot_targets(targets, &error_mask) == false && error_mask == 0) {
+        return false;
+    }
+
+    foot_target_error_mask = error_mask;
+    if (error_mask != 0 && foot_target_error_count < 0xFFFF) {
+        ++foot_target_error_count;
+    }
+
+    response[0] = frame[0];
+    response[1] = error_mask;
+    return true;
+}
\ No newline at end of file
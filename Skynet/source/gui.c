@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include "oled_gl.h"
 #include "monitoring.h"
+#include "profiler.h"
 #include "systimer.h"
 #include "error_handling.h"
 #include "version.h"
@@ -151,6 +152,7 @@ typedef enum {
     STATE_UPDATE_PERIPHERY_VOLTAGE,
     STATE_UPDATE_WIRELESS_VOLTAGE,
     STATE_UPDATE_ERROR_STATUS,
+    STATE_UPDATE_LOOP_FREQUENCY,
     STATE_UPDATE_SYSTEM_MODE,
     STATE_UPDATE_DISPLAY
 } state_t;
@@ -195,6 +197,11 @@ void gui_init(void) {
     // Draw horizontal separator
     oled_gl_draw_horizontal_line(5, 0, 7, 128);
     
+    // Draw main loop frequency
+    oled_gl_draw_string(6, 0, "LOOP");
+    oled_gl_draw_dec_number(6, 30, 0);
+    oled_gl_draw_string(6, 72, "Hz");
+    
     // Draw error status
     oled_gl_draw_hex_number(7, 0, 0x00000000);
     
@@ -250,6 +257,12 @@ void gui_process(void) {
             
         case STATE_UPDATE_ERROR_STATUS:
             oled_gl_draw_hex_number(7, 0, error_status);
+            module_state = STATE_UPDATE_LOOP_FREQUENCY;
+            break;
+            
+        case STATE_UPDATE_LOOP_FREQUENCY:
+            oled_gl_clear_row_fragment(6, 30, 0, 36, 8);
+            oled_gl_draw_dec_number(6, 30, profiler_loop_frequency);
             module_state = STATE_UPDATE_SYSTEM_MODE;
             break;
             
@@ -0,0 +1,178 @@
+//  ***************************************************************************
+/// @file    joint_stream.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "joint_stream.h"
+
+#include <sam.h>
+#include <string.h>
+#include "control_loop.h"
+#include "systimer.h"
+#include "time_sync.h"
+
+#define JITTER_DELAY                        (20000)     // us, playout delay from first frame receive
+#define STREAM_TIMEOUT                      (500000)    // us, stream stopped if no frame received
+
+
+typedef struct {
+    uint32_t timestamp;                     // Host time [us]
+    int16_t  angles[JOINT_STREAM_JOINT_COUNT];
+} stream_frame_t;
+
+
+uint16_t joint_stream_underrun_count = 0;   // Read only
+uint16_t joint_stream_drop_count = 0;       // Read only
+uint8_t  joint_stream_buffer_level = 0;     // Read only
+
+// Jitter buffer. Frames sorted by timestamp, first frame is oldest
+static stream_frame_t buffer[JOINT_STREAM_BUFFER_SIZE] = { 0 };
+static uint32_t buffer_count = 0;
+
+static stream_frame_t current_frame = { 0 };
+static bool     is_current_frame_valid = false;
+static bool     is_stream_active = false;
+static uint32_t playout_offset = 0;         // Local time - host time [us]
+static uint32_t last_receive_time = 0;
+
+
+static bool insert_frame(const stream_frame_t* frame);
+static void increment_counter(uint16_t* counter, uint32_t value);
+
+
+//  ***************************************************************************
+/// @brief  Push frame to jitter buffer
+/// @note   Frame: [timestamp (uint32, us)][angles (int16, 0.1 deg) x 18], big-endian.
+///         Frame is played JITTER_DELAY after its timestamp if host clock
+///         is synchronized. Otherwise first frame of stream sets playout
+///         time: frame is played JITTER_DELAY after its receive
+/// @param  frame: pointer to frame
+/// @return true - frame accepted, false - buffer overflow
+//  ***************************************************************************
+bool joint_stream_push_frame(const uint8_t* frame) {
+
+    stream_frame_t new_frame;
+    new_frame.timestamp = (frame[0] << 24) | (frame[1] << 16) | (frame[2] << 8) | frame[3];
+    for (uint32_t i = 0; i < JOINT_STREAM_JOINT_COUNT; ++i) {
+        new_frame.angles[i] = (int16_t)((frame[4 + i * 2] << 8) | frame[5 + i * 2]);
+    }
+
+    control_loop_lock();
+
+    uint32_t current_time = get_time_us();
+    if (is_stream_active == false) {
+        playout_offset = current_time - new_frame.timestamp + JITTER_DELAY;
+        buffer_count = 0;
+        is_current_frame_valid = false;
+        is_stream_active = true;
+    }
+    last_receive_time = current_time;
+
+    bool result = insert_frame(&new_frame);
+    joint_stream_buffer_level = buffer_count;
+
+    control_loop_unlock();
+    return result;
+}
+
+//  ***************************************************************************
+/// @brief  Get joint angles for current frame
+/// @note   Call from control loop once per frame. Last frame angles hold if
+///         buffer is empty
+/// @param  angles: angles buffer [deg], JOINT_STREAM_JOINT_COUNT items
+/// @return true - stream active, false - no angles
+//  ***************************************************************************
+bool joint_stream_get_angles(float* angles) {
+
+    if (is_stream_active == false) {
+        return false;
+    }
+
+    uint32_t current_time = get_time_us();
+    if (current_time - last_receive_time > STREAM_TIMEOUT) {
+        is_stream_active = false;
+        buffer_count = 0;
+        joint_stream_buffer_level = 0;
+        return false;
+    }
+
+    // Take latest frame with reached playout time, older frames skipped
+    uint32_t playout_time = current_time - playout_offset;
+    if (time_sync_is_valid() == true) {
+        playout_time = time_sync_local_to_host(current_time - JITTER_DELAY);
+    }
+    uint32_t count = 0;
+    while (count < buffer_count && (int32_t)(buffer[count].timestamp - playout_time) <= 0) {
+        ++count;
+    }
+
+    if (count != 0) {
+        current_frame = buffer[count - 1];
+        is_current_frame_valid = true;
+        buffer_count -= count;
+        memmove(&buffer[0], &buffer[count], buffer_count * sizeof(stream_frame_t));
+        increment_counter(&joint_stream_drop_count, count - 1);
+    }
+    else if (buffer_count == 0 && is_current_frame_valid == true) {
+        increment_counter(&joint_stream_underrun_count, 1);
+    }
+    joint_stream_buffer_level = buffer_count;
+
+    if (is_current_frame_valid == false) {
+        return false;
+    }
+    for (uint32_t i = 0; i < JOINT_STREAM_JOINT_COUNT; ++i) {
+        angles[i] = current_frame.angles[i] / 10.0f;
+    }
+    return true;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Insert frame to jitter buffer by timestamp
+/// @note   Call with locked control loop. Late frames are dropped
+/// @param  frame: pointer to frame
+/// @return true - frame accepted, false - buffer overflow
+//  ***************************************************************************
+static bool insert_frame(const stream_frame_t* frame) {
+
+    // Frame is older than played frame
+    if (is_current_frame_valid == true && (int32_t)(frame->timestamp - current_frame.timestamp) <= 0) {
+        increment_counter(&joint_stream_drop_count, 1);
+        return true;
+    }
+
+    // Find position. Frame with same timestamp is replaced
+    uint32_t position = buffer_count;
+    while (position > 0 && (int32_t)(frame->timestamp - buffer[position - 1].timestamp) <= 0) {
+        --position;
+    }
+    if (position < buffer_count && buffer[position].timestamp == frame->timestamp) {
+        buffer[position] = *frame;
+        return true;
+    }
+
+    if (buffer_count >= JOINT_STREAM_BUFFER_SIZE) {
+        increment_counter(&joint_stream_drop_count, 1);
+        return false;
+    }
+
+    memmove(&buffer[position + 1], &buffer[position], (buffer_count - position) * sizeof(stream_frame_t));
+    buffer[position] = *frame;
+    ++buffer_count;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Increment statistic counter with saturation
+/// @param  counter: pointer to counter
+/// @param  value: increment value
+/// @return none
+//  ***************************************************************************
+static void increment_counter(uint16_t* counter, uint32_t value) {
+
+    uint32_t result = *counter + value;
+    *counter = (result > 0xFFFF) ? 0xFFFF : result;
+}
\ No newline at end of file
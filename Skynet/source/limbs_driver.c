@@ -6,18 +6,26 @@
 
 #include <sam.h>
 #include <fastmath.h>
+#include <string.h>
 #include "servo_driver.h"
 #include "veeprom.h"
 #include "veeprom_map.h"
 #include "systimer.h"
 #include "pwm.h"
 #include "error_handling.h"
+#include "joint_stream.h"
+#include "control_loop.h"
+#include "trajectory.h"
 #define RAD_TO_DEG(rad)                     ((rad) * 180.0f / M_PI)
 #define DEG_TO_RAD(deg)                     ((deg) * M_PI / 180.0f)
 
 #define SMOOTH_DEFAULT_TOTAL_POINT_COUNT    (30)
 #define OVERRIDE_DISABLE_VALUE              (0x7F)
 
+#define CALC_TIME_BUDGET_PERCENT            (50)        // Max part of frame period for angles calculation
+#define CALC_BUDGET_OVERRUN_LIMIT           (3)         // Overrun frames in a row before frame rate fallback
+#define FALLBACK_FRAME_RATE_HZ              (PWM_DEFAULT_FREQUENCY_HZ)
+
 
 // Servo driver states
 typedef enum {
@@ -65,16 +73,29 @@ typedef struct {
 
 int8_t ram_link_angles_override[SUPPORT_LIMB_COUNT * 3] = {0};    // Write only
 int8_t ram_link_angles[SUPPORT_LIMB_COUNT * 3] = {0};            // Read only
+uint16_t ram_limbs_calc_time_max = 0;                           // Read only
 
 static driver_state_t driver_state = STATE_NOINIT;
 static limb_info_t    limbs[SUPPORT_LIMB_COUNT] = {0};
 static bool           is_limbs_move_started = false;
+static uint32_t       smooth_base_point_count = SMOOTH_DEFAULT_TOTAL_POINT_COUNT;
 static uint32_t       smooth_total_point_count = SMOOTH_DEFAULT_TOTAL_POINT_COUNT;
+static uint32_t       smooth_current_point = 0;
+static uint32_t       calc_overrun_count = 0;
+
+static limb_info_t    foot_targets[SUPPORT_LIMB_COUNT] = {0};    // Positions and angles for next frame
+static volatile bool  is_foot_targets_pending = false;
+static bool           is_positions_stale = false;       // Angles applied without IK (stream, joints trajectory, override)
 
 
 static bool read_configuration(void);
+static uint32_t scale_point_count(uint32_t base_point_count, uint32_t frame_rate);
+static void check_calc_time_budget(uint32_t calc_time);
 static void path_calculate_point(const path_3d_t* info, point_3d_t* point, uint32_t smooth_current_point);
 static bool kinematic_calculate_angles(limb_info_t* info);
+static void kinematic_calculate_position(limb_info_t* info);
+static bool is_angles_in_range(const limb_info_t* info);
+static bool load_trajectory_point(const int16_t* point);
 
 
 //  ***************************************************************************
@@ -122,15 +143,18 @@ void limbs_driver_init(void) {
 
 //  ***************************************************************************
 /// @brief  Start smooth algorithm configuration
-/// @param  point_count: smooth point count
+/// @note   Point count rescale from base frame rate to current PWM frame rate
+/// @param  point_count: smooth point count for LIMBS_DRIVER_BASE_FRAME_RATE_HZ
 //  ***************************************************************************
 void limbs_driver_set_smooth_config(uint32_t point_count) {
     
-    smooth_total_point_count = point_count;
-
-    if (smooth_total_point_count == 0) {
+    if (point_count == 0) {
         callback_set_internal_error(ERROR_MODULE_LIMBS_DRIVER);
+        return;
     }
+    
+    smooth_base_point_count  = point_count;
+    smooth_total_point_count = scale_point_count(point_count, pwm_get_frequency());
 }
 
 //  ***************************************************************************
@@ -145,6 +169,14 @@ void limbs_driver_start_move(const point_3d_t* point_list, const path_type_t* pa
         return;
     }
     
+    // Movement start from last applied angles, not from last IK position
+    if (is_positions_stale == true) {
+        for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+            kinematic_calculate_position(&limbs[i]);
+        }
+        is_positions_stale = false;
+    }
+    
     // Prepare limbs for movement
     for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
         
@@ -172,32 +204,93 @@ bool limbs_driver_is_move_complete(void) {
     return is_limbs_move_started == false;
 }
 
+//  ***************************************************************************
+/// @brief  Set foot targets for next frame
+/// @note   Call from background only (takes control loop lock). Targets
+///         are rejected if any limb target is unreachable or link angle is
+///         out of range. Angles are calculated here, control loop (PendSV)
+///         load them on next frame
+/// @param  targets: foot positions list
+/// @param  error_mask: bit per limb with bad target, 0 if driver busy
+/// @return true - targets accepted, false - bad targets or movement in progress
+//  ***************************************************************************
+bool limbs_driver_set_foot_targets(const point_3d_t* targets, uint8_t* error_mask) {
+    
+    *error_mask = 0;
+    if (driver_state == STATE_NOINIT || is_limbs_move_started == true) {
+        return false;
+    }
+    
+    // Calculate angles for targets
+    limb_info_t new_targets[SUPPORT_LIMB_COUNT];
+    for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+        
+        new_targets[i] = limbs[i];
+        new_targets[i].position = targets[i];
+        if (kinematic_calculate_angles(&new_targets[i]) == false || is_angles_in_range(&new_targets[i]) == false) {
+            *error_mask |= (1 << i);
+        }
+    }
+    if (*error_mask != 0) {
+        return false;
+    }
+    
+    control_loop_lock();
+    memcpy(foot_targets, new_targets, sizeof(foot_targets));
+    is_foot_targets_pending = true;
+    control_loop_unlock();
+    return true;
+}
+
 //  ***************************************************************************
 /// @brief  Limbs driver process
-/// @note   Call from main loop
+/// @note   Call from control loop (PendSV) once per frame
 //  ***************************************************************************
 void limbs_driver_process(void) {
     
     if (callback_is_limbs_driver_error_set() == true) return;  // Module disabled
     
 
-    static uint32_t smooth_current_point = 0;
     static uint32_t prev_synchro_value = 0xFFFFFFFF;
+    uint32_t calc_start_time = 0;
     
     switch (driver_state) {
         
         case STATE_WAIT:
-            if (synchro != prev_synchro_value) {
+            if (synchro == prev_synchro_value) {
+                break;
+            }
+            
+            // Frames missed - skip path points for catch up with frame time
+            if (synchro - prev_synchro_value > 1 && prev_synchro_value != 0xFFFFFFFF && is_limbs_move_started == true) {
                 
-                if (synchro - prev_synchro_value > 1 && prev_synchro_value != 0xFFFFFFFF) {
-                    callback_set_sync_error(ERROR_MODULE_LIMBS_DRIVER);
+                smooth_current_point += synchro - prev_synchro_value - 1;
+                if (smooth_current_point > smooth_total_point_count) {
+                    smooth_current_point = smooth_total_point_count;
                 }
-                prev_synchro_value = synchro;
-                driver_state = STATE_CALC;
             }
-            break;
+            prev_synchro_value = synchro;
+            driver_state = STATE_CALC;
+            // fall through - calculate angles in same frame
         
         case STATE_CALC:
+            calc_start_time = get_time_us();
+            
+            // Load foot targets. Movement has priority
+            if (is_foot_targets_pending == true) {
+                
+                if (is_limbs_move_started == false) {
+                    for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+                        limbs[i].position = foot_targets[i].position;
+                        limbs[i].links[LINK_COXA].angle  = foot_targets[i].links[LINK_COXA].angle;
+                        limbs[i].links[LINK_FEMUR].angle = foot_targets[i].links[LINK_FEMUR].angle;
+                        limbs[i].links[LINK_TIBIA].angle = foot_targets[i].links[LINK_TIBIA].angle;
+                    }
+                    is_positions_stale = false;
+                }
+                is_foot_targets_pending = false;
+            }
+        
             //
             // Calculate new servo angles
             //
@@ -221,22 +314,45 @@ void limbs_driver_process(void) {
                     smooth_current_point = 0;
                 }
             }            
+            
+            // Trajectory playback replace calculated angles
+            const int16_t* trajectory_point = trajectory_get_point();
+            if (trajectory_point != NULL && load_trajectory_point(trajectory_point) == false) {
+                trajectory_abort();
+            }
+            bool is_angles_overridden = (trajectory_point != NULL && trajectory_type == TRAJECTORY_TYPE_JOINTS);
                
             //
             // Load new angles to servo driver
             //
+            float stream_angles[JOINT_STREAM_JOINT_COUNT];
+            bool is_stream_active = joint_stream_get_angles(stream_angles);
+            if (is_stream_active == true) {
+                is_angles_overridden = true;
+            }
+            
             servo_driver_set_update_state(SERVO_DRIVER_UPDATE_DISABLE);
             for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+                
+                // Streamed angles replace calculated angles
+                if (is_stream_active == true) {
+                    limbs[i].links[LINK_COXA].angle  = stream_angles[i * 3 + 0];
+                    limbs[i].links[LINK_FEMUR].angle = stream_angles[i * 3 + 1];
+                    limbs[i].links[LINK_TIBIA].angle = stream_angles[i * 3 + 2];
+                }
                  
                 // Override process
                 if (ram_link_angles_override[i * 3 + 0] != OVERRIDE_DISABLE_VALUE) {
                     limbs[i].links[LINK_COXA].angle = ram_link_angles_override[i * 3 + 0];
+                    is_angles_overridden = true;
                 }
                 if (ram_link_angles_override[i * 3 + 1] != OVERRIDE_DISABLE_VALUE) {
                     limbs[i].links[LINK_FEMUR].angle = ram_link_angles_override[i * 3 + 1];
+                    is_angles_overridden = true;
                 }
                 if (ram_link_angles_override[i * 3 + 2] != OVERRIDE_DISABLE_VALUE) {
                     limbs[i].links[LINK_TIBIA].angle = ram_link_angles_override[i * 3 + 2];
+                    is_angles_overridden = true;
                 }
                                 
                 // Move servos to destination angles
@@ -250,6 +366,13 @@ void limbs_driver_process(void) {
                 ram_link_angles[i * 3 + 2] = limbs[i].links[LINK_TIBIA].angle;
             }
             servo_driver_set_update_state(SERVO_DRIVER_UPDATE_ENABLE);
+            
+            // Positions are recalculated from applied angles on next movement start
+            if (is_angles_overridden == true) {
+                is_positions_stale = true;
+            }
+            
+            check_calc_time_budget(get_time_us() - calc_start_time);
             driver_state = STATE_WAIT;
             break;
         
@@ -320,6 +443,56 @@ static bool read_configuration(void) {
     return true;
 }
 
+//  ***************************************************************************
+/// @brief  Scale smooth point count to PWM frame rate
+/// @param  base_point_count: point count for LIMBS_DRIVER_BASE_FRAME_RATE_HZ
+/// @param  frame_rate: PWM frame rate [Hz]
+/// @return point count for frame rate
+//  ***************************************************************************
+static uint32_t scale_point_count(uint32_t base_point_count, uint32_t frame_rate) {
+    
+    uint32_t point_count = (base_point_count * frame_rate + LIMBS_DRIVER_BASE_FRAME_RATE_HZ / 2) / LIMBS_DRIVER_BASE_FRAME_RATE_HZ;
+    if (point_count == 0) {
+        point_count = 1;
+    }
+    return point_count;
+}
+
+//  ***************************************************************************
+/// @brief  Check angles calculation time fit frame budget
+/// @note   Fallback to lower frame rate if calculation not fit frame budget
+///         several frames in a row. Current movement continue from same
+///         path position with new point count
+/// @param  calc_time: angles calculation time [us]
+/// @return none
+//  ***************************************************************************
+static void check_calc_time_budget(uint32_t calc_time) {
+    
+    if (calc_time > ram_limbs_calc_time_max) {
+        ram_limbs_calc_time_max = (calc_time > 0xFFFF) ? 0xFFFF : calc_time;
+    }
+    
+    uint32_t budget = (1000000 / pwm_get_frequency()) * CALC_TIME_BUDGET_PERCENT / 100;
+    if (calc_time <= budget) {
+        calc_overrun_count = 0;
+        return;
+    }
+    
+    ++calc_overrun_count;
+    if (calc_overrun_count < CALC_BUDGET_OVERRUN_LIMIT || pwm_get_frequency() <= FALLBACK_FRAME_RATE_HZ) {
+        return;
+    }
+    
+    // Fallback to lower frame rate. New rate apply on next frame start,
+    // so point count is scaled to fallback rate, not to current one
+    calc_overrun_count = 0;
+    pwm_set_frequency(FALLBACK_FRAME_RATE_HZ);
+    
+    uint32_t prev_total_point_count = smooth_total_point_count;
+    smooth_total_point_count = scale_point_count(smooth_base_point_count, FALLBACK_FRAME_RATE_HZ);
+    smooth_current_point = smooth_current_point * smooth_total_point_count / prev_total_point_count;
+}
+
 //  ***************************************************************************
 /// @brief  Calculate path point
 /// @param  info: path info @ref path_3d_t
@@ -428,7 +601,7 @@ static bool kinematic_calculate_angles(limb_info_t* info) {
 
     // Calculate distance to destination point
     float d = sqrt(x1 * x1 + y1 * y1);
-    if (d > femur_length + tibia_length) {
+    if (d > femur_length + tibia_length || d < fabs((float)femur_length - (float)tibia_length)) {
         return false; // Point not attainable
     }
     
@@ -464,3 +637,83 @@ static bool kinematic_calculate_angles(limb_info_t* info) {
     }*/
     return true;
 }
+
+//  ***************************************************************************
+/// @brief  Calculate foot position by link angles (forward kinematic)
+/// @note   Inverse of kinematic_calculate_angles()
+/// @param  info: limb info @ref limb_info_t
+/// @return none
+//  ***************************************************************************
+static void kinematic_calculate_position(limb_info_t* info) {
+    
+    uint32_t coxa_length = info->links[LINK_COXA].length;
+    uint32_t femur_length = info->links[LINK_FEMUR].length;
+    uint32_t tibia_length = info->links[LINK_TIBIA].length;
+    
+    // Femur direction and angle between femur and tibia
+    float femur_rad = DEG_TO_RAD(info->links[LINK_FEMUR].zero_rotate - info->links[LINK_FEMUR].angle);
+    float gamma = DEG_TO_RAD(info->links[LINK_TIBIA].angle + info->links[LINK_TIBIA].zero_rotate);
+    
+    // Foot point in (X*, Y*) coordinate system (coxa plane)
+    float x1 = femur_length * cos(femur_rad) - tibia_length * cos(femur_rad + gamma) + coxa_length;
+    float y1 = femur_length * sin(femur_rad) - tibia_length * sin(femur_rad + gamma);
+    
+    // Rotate by coxa angle
+    float coxa_angle_rad = DEG_TO_RAD(info->links[LINK_COXA].angle);
+    float z1 = x1 * sin(coxa_angle_rad);
+    x1 = x1 * cos(coxa_angle_rad);
+    
+    // Move to (X, Y, Z) coordinate system - rotate back
+    float coxa_zero_rotate_rad = DEG_TO_RAD(info->links[LINK_COXA].zero_rotate);
+    info->position.x = x1 * cos(coxa_zero_rotate_rad) - z1 * sin(coxa_zero_rotate_rad);
+    info->position.y = y1;
+    info->position.z = x1 * sin(coxa_zero_rotate_rad) + z1 * cos(coxa_zero_rotate_rad);
+}
+
+//  ***************************************************************************
+/// @brief  Check link angles range
+/// @param  info: limb info
+/// @return true - all link angles in range, false - no
+//  ***************************************************************************
+static bool is_angles_in_range(const limb_info_t* info) {
+    
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (info->links[i].angle < info->links[i].min_angle || info->links[i].angle > info->links[i].max_angle) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Load trajectory point to limbs
+/// @note   Joints point loaded without calculations. Foot targets point is
+///         loaded only if all targets reachable
+/// @param  point: trajectory point
+/// @return true - success, false - point is unreachable
+//  ***************************************************************************
+static bool load_trajectory_point(const int16_t* point) {
+    
+    if (trajectory_type == TRAJECTORY_TYPE_JOINTS) {
+        for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+            limbs[i].links[LINK_COXA].angle  = point[i * 3 + 0] / 10.0f;
+            limbs[i].links[LINK_FEMUR].angle = point[i * 3 + 1] / 10.0f;
+            limbs[i].links[LINK_TIBIA].angle = point[i * 3 + 2] / 10.0f;
+        }
+        return true;
+    }
+    
+    limb_info_t new_limbs[SUPPORT_LIMB_COUNT];
+    for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+        
+        new_limbs[i] = limbs[i];
+        new_limbs[i].position.x = point[i * 3 + 0];
+        new_limbs[i].position.y = point[i * 3 + 1];
+        new_limbs[i].position.z = point[i * 3 + 2];
+        if (kinematic_calculate_angles(&new_limbs[i]) == false || is_angles_in_range(&new_limbs[i]) == false) {
+            return false;
+        }
+    }
+    memcpy(limbs, new_limbs, sizeof(limbs));
+    return true;
+}
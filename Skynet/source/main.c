@@ -12,18 +12,54 @@
 #include "orientation.h"
 #include "veeprom.h"
 #include "modbus.h"
+#include "wireless_modbus.h"
+#include "teleop.h"
+#include "emergency_stop.h"
 #include "scr.h"
 #include "led.h"
 #include "i2c.h"
 #include "gui.h"
 #include "buzzer.h"
 #include "systimer.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "control_loop.h"
 #include "error_handling.h"
 
 
+static void check_system_status(void);
 static void enter_to_emergency_loop(void);
 
 
+// Task list order is task priority. Movement engine, limbs driver and servo
+// driver run in control loop (PendSV) on PWM frame start
+static scheduler_task_t normal_mode_task_list[] = {
+    // Task ID                   Period                   Budget [us]   Sheddable   Process function
+    { TASK_ID_SYSTEM_STATUS,     TASK_PERIOD_1KHZ,        50,           false,      check_system_status     },
+    { TASK_ID_MODBUS,            TASK_PERIOD_1KHZ,        500,          false,      modbus_process          },
+    { TASK_ID_WIRELESS_MODBUS,   TASK_PERIOD_1KHZ,        500,          false,      wireless_modbus_process },
+    { TASK_ID_ORIENTATION,       TASK_PERIOD_1KHZ,        100,          true,       orientation_process     },
+    { TASK_ID_SCR,               TASK_PERIOD_100HZ,       200,          false,      scr_process             },
+    { TASK_ID_TELEOP,            TASK_PERIOD_100HZ,       50,           false,      teleop_process          },
+    { TASK_ID_GUI,               TASK_PERIOD_100HZ,       1000,         true,       gui_process             },
+    { TASK_ID_BUZZER,            TASK_PERIOD_100HZ,       50,           false,      buzzer_process          },
+    { TASK_ID_LED,               TASK_PERIOD_10HZ,        50,           false,      led_process             },
+    { TASK_ID_VEEPROM,           TASK_PERIOD_10HZ,        20000,        false,      veeprom_process         },
+    { TASK_ID_MONITORING,        TASK_PERIOD_BACKGROUND,  200,          false,      monitoring_process      }
+};
+
+static scheduler_task_t emergency_mode_task_list[] = {
+    // Task ID                   Period                   Budget [us]   Sheddable   Process function
+    { TASK_ID_MODBUS,            TASK_PERIOD_1KHZ,        500,          false,      modbus_process          },
+    { TASK_ID_WIRELESS_MODBUS,   TASK_PERIOD_1KHZ,        500,          false,      wireless_modbus_process },
+    { TASK_ID_SCR,               TASK_PERIOD_100HZ,       200,          false,      scr_process             },
+    { TASK_ID_GUI,               TASK_PERIOD_100HZ,       1000,         true,       gui_process             },
+    { TASK_ID_LED,               TASK_PERIOD_10HZ,        50,           false,      led_process             },
+    { TASK_ID_VEEPROM,           TASK_PERIOD_10HZ,        20000,        false,      veeprom_process         },
+    { TASK_ID_MONITORING,        TASK_PERIOD_BACKGROUND,  200,          false,      monitoring_process      }
+};
+
+
 
 //  ***************************************************************************
 /// @brief  Normal mode loop
@@ -46,49 +82,46 @@ int main(void) {
 
     // Initialize FW
     systimer_init();
+    profiler_reset();
 	led_init();
     i2c_init(I2C_SPEED_400KHZ);
     gui_init();
     veeprom_init();
     modbus_init();
+    wireless_modbus_init();
     monitoring_init();
 	orientation_init();
     
     servo_driver_init();
     limbs_driver_init();
     movement_engine_init();
+    control_loop_init();
     
     buzzer_init();
     
     while (1)  {
-        
-        //
-        // CHECK SYSTEM STATUS
-        //
-        if (callback_is_emergency_mode_active() == true) {
-            enter_to_emergency_loop();
-        }
-        if (callback_is_voltage_error_set() == true) {
-            movement_engine_select_sequence(SEQUENCE_DOWN);
-        }
-        
-        
-        //
-        // NORMAL MODE PROCESS
-        //
-        gui_process();
-        led_process();
-        buzzer_process();
-        
-        servo_driver_process();
-        limbs_driver_process();
-        movement_engine_process();
-        
-        modbus_process();
-        scr_process();
-        
-        monitoring_process();
-		orientation_process();
+        scheduler_process(normal_mode_task_list, sizeof(normal_mode_task_list) / sizeof(normal_mode_task_list[0]));
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Check system status
+/// @param  none
+/// @return none
+//  ***************************************************************************
+static void check_system_status(void) {
+    
+    // PWM already frozen by USART ISR
+    if (emergency_stop_is_active() == true) {
+        callback_set_emergency_stop();
+    }
+    if (callback_is_emergency_mode_active() == true) {
+        enter_to_emergency_loop();
+    }
+    if (callback_is_voltage_error_set() == true) {
+        control_loop_lock();
+        movement_engine_select_sequence(SEQUENCE_DOWN);
+        control_loop_unlock();
     }
 }
 
@@ -100,14 +133,7 @@ int main(void) {
 static void enter_to_emergency_loop(void) {
     
     while (1)  {
-        
-        gui_process();
-        led_process();
-        
-        modbus_process();
-        scr_process();
-        
-        monitoring_process();
+        scheduler_process(emergency_mode_task_list, sizeof(emergency_mode_task_list) / sizeof(emergency_mode_task_list[0]));
     }
 }
 
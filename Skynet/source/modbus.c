@@ -8,21 +8,40 @@
 #include <string.h>
 #include "ram_map.h"
 #include "veeprom.h"
-#include "usart0_pdc.h"
-#include "usart3_pdc.h"
-
-#define SUPPORT_USART_COUNT                     (2)
-#define USART_BAUD_RATE                         (115200)
-
-#define CRC16_POLYNOM                           (0xA001)    // CRC polynom
+#include "usart_pdc.h"
+#include "crc16.h"
+#include "systimer.h"
+#include "teleop.h"
+#include "joint_stream.h"
+#include "foot_target.h"
+#include "time_sync.h"
+
+#define SUPPORT_USART_COUNT                     (MODBUS_PORT_COUNT)
+#define USART_BAUD_RATE                         (115200)    // Default baud rate
+#define USART_MIN_BAUD_RATE                     (9600)
+#define USART_MAX_BAUD_RATE                     (SystemCoreClock / 16)  // CD = 1
+#define USART_TX_BUFFER_SIZE                    (128)
+#define USART_RX_BUFFER_SIZE                    (256)       // RX ring size (power of 2)
+#define USART_RX_TIMEOUT                        (35)        // Bit periods, 3.5 characters
+#define USART_RX_TIMEOUT_MIN                    (750)       // us, USB-serial adapter packet gaps. Emergency stop latency < 1 ms
+#define BAUD_RATE_CONFIRM_TIMEOUT               (1000)      // ms, valid frame at new baud rate wait time
 
 #define MB_MIN_REQUEST_SIZE                     (7)
+#define MB_MAX_REQUEST_SIZE                     (128)
 #define MB_READ_RAM_CMD_MIN_LENGTH              (7)
 #define MB_WRITE_RAM_CMD_MIN_LENGTH             (8)
 #define MB_READ_EEPROM_CMD_MIN_LENGTH           (7)
 #define MB_WRITE_EEPROM_CMD_MIN_LENGTH          (8)
-
-#define MAX_READ_RAM_SIZE                       (32)
+#define MB_READ_RAM_RANGES_CMD_MIN_LENGTH       (8)
+#define MB_READ_RAM_RANGE_DESCRIPTOR_SIZE       (3)         // Address (2 bytes) + bytes count (1 byte)
+#define MB_SET_BAUD_RATE_CMD_MIN_LENGTH         (8)
+#define MB_TELEOP_CMD_LENGTH                    (4 + TELEOP_COMMAND_SIZE)
+#define MB_JOINT_STREAM_CMD_LENGTH              (4 + JOINT_STREAM_FRAME_SIZE)
+#define MB_FOOT_TARGETS_CMD_LENGTH              (4 + FOOT_TARGET_FRAME_SIZE)
+#define MB_TIME_SYNC_CMD_LENGTH                 (4 + TIME_SYNC_REQUEST_SIZE)
+
+#define MAX_READ_RAM_SIZE                       (120)       // Limited by TX buffer size (128 bytes - 5 bytes of response header and CRC)
+#define MAX_READ_RAM_RANGE_COUNT                (32)
 #define MAX_WRITE_RAM_SIZE                      (32)
 #define MAX_READ_EEPROM_SIZE                    (32)
 #define MAX_WRITE_EEPROM_SIZE                   (16)
@@ -31,6 +50,13 @@
 #define MB_CMD_WRITE_EEPROM                     (0x43) // ModBus Function Code: Write EEPROM
 #define MB_CMD_READ_RAM                         (0x44) // ModBus Function Code: Read RAM
 #define MB_CMD_READ_EEPROM                      (0x46) // ModBus Function Code: Read EEPROM
+#define MB_CMD_READ_RAM_RANGES                  (0x48) // ModBus Function Code: Read several RAM ranges
+#define MB_CMD_SET_BAUD_RATE                    (0x4B) // ModBus Function Code: Switch baud rate after response
+#define MB_CMD_TELEOP                           (0x4C) // ModBus Function Code: Teleoperation command
+#define MB_CMD_EMERGENCY_STOP                   (0x4D) // ModBus Function Code: Emergency stop (processed in USART ISR)
+#define MB_CMD_JOINT_STREAM                     (0x4E) // ModBus Function Code: Joint angles stream frame
+#define MB_CMD_FOOT_TARGETS                     (0x4F) // ModBus Function Code: Foot targets stream frame
+#define MB_CMD_TIME_SYNC                        (0x50) // ModBus Function Code: Host clock synchronization
 
 #define MB_OK                                   (0x00)
 #define MB_EXCEPTION_ILLEGAL_FUNCTION           (0x01) // ModBus Exception code: Illegal Function. Requested Function is not supported, or is not supported in current Device mode.
@@ -40,57 +66,67 @@
 #define MB_BAD_FRAME                            (0xFF)
 
 
-typedef struct {
-    
-    void(*usart_init)(uint32_t baud_rate);
-    void(*usart_reset)(bool is_reset_transmitter, bool is_reset_receiver);
-    bool(*usart_is_error)(void);
-    void(*usart_start_tx)(uint32_t bytes_count);
-    bool(*usart_is_tx_complete)(void);
-    uint8_t*(*usart_get_internal_tx_buffer_address)(void);
-    void(*usart_start_rx)(uint8_t* external_rx_buffer, uint32_t external_buffer_size);
-    bool(*usart_is_frame_received)(void);
-    uint32_t(*usart_get_frame_size)(void);
-    const uint8_t*(*usart_get_internal_rx_buffer_address)(void);
-    
-} usart_info_t;
+static uint8_t usart_tx_buffer[SUPPORT_USART_COUNT][USART_TX_BUFFER_SIZE] = { 0 };
+static uint8_t usart_rx_buffer[SUPPORT_USART_COUNT][USART_RX_BUFFER_SIZE] = { 0 };
 
-
-static const usart_info_t usarts[SUPPORT_USART_COUNT] = {
+static usart_pdc_t usarts[SUPPORT_USART_COUNT] = {
     
     {
-        .usart_init = usart0_init,
-        .usart_reset = usart0_reset,
-        .usart_is_error = usart0_is_error,
-        .usart_start_tx = usart0_start_tx,
-        .usart_is_tx_complete = usart0_is_tx_complete,
-        .usart_get_internal_tx_buffer_address = usart0_get_internal_tx_buffer_address,
-        .usart_start_rx = usart0_start_rx,
-        .usart_is_frame_received = usart0_is_frame_received,
-        .usart_get_frame_size = usart0_get_frame_size,
-        .usart_get_internal_rx_buffer_address = usart0_get_internal_rx_buffer_address
+        .instance = USART_PDC_USART0,
+        .tx_buffer = usart_tx_buffer[0],
+        .tx_buffer_size = USART_TX_BUFFER_SIZE,
+        .tx_buffer_count = 1,
+        .rx_buffer = usart_rx_buffer[0],
+        .rx_buffer_size = USART_RX_BUFFER_SIZE,
+        .rx_timeout = USART_RX_TIMEOUT,
+        .rx_timeout_min = USART_RX_TIMEOUT_MIN
     },
     {
-        .usart_init = usart3_init,
-        .usart_reset = usart3_reset,
-        .usart_is_error = usart3_is_error,
-        .usart_start_tx = usart3_start_tx,
-        .usart_is_tx_complete = usart3_is_tx_complete,
-        .usart_get_internal_tx_buffer_address = usart3_get_internal_tx_buffer_address,
-        .usart_start_rx = usart3_start_rx,
-        .usart_is_frame_received = usart3_is_frame_received,
-        .usart_get_frame_size = usart3_get_frame_size,
-        .usart_get_internal_rx_buffer_address = usart3_get_internal_rx_buffer_address
+        // USART3 is used by wireless link (radio module pins), second port on USART1
+        .instance = USART_PDC_USART1,
+        .tx_buffer = usart_tx_buffer[1],
+        .tx_buffer_size = USART_TX_BUFFER_SIZE,
+        .tx_buffer_count = 1,
+        .rx_buffer = usart_rx_buffer[1],
+        .rx_buffer_size = USART_RX_BUFFER_SIZE,
+        .rx_timeout = USART_RX_TIMEOUT,
+        .rx_timeout_min = USART_RX_TIMEOUT_MIN
     }
 };
 
 
-static bool     is_request_valid(const uint8_t* request, uint32_t size);
+modbus_port_statistic_t modbus_statistic[MODBUS_PORT_COUNT] = { 0 };    // Read only
+
+static uint8_t  request_buffer[SUPPORT_USART_COUNT][MB_MAX_REQUEST_SIZE] = { 0 };   // Request copied from RX ring
+static uint16_t rx_crc[SUPPORT_USART_COUNT] = { 0 };
+static bool     is_tx_wait_counted[SUPPORT_USART_COUNT] = { 0 };
+static uint32_t rx_crc_size[SUPPORT_USART_COUNT] = { 0 };
+
+static uint32_t baud_rate[SUPPORT_USART_COUNT] = { 0 };
+static uint32_t pending_baud_rate[SUPPORT_USART_COUNT] = { 0 };        // 0 - no pending switch
+static uint32_t baud_rate_switch_time[SUPPORT_USART_COUNT] = { 0 };
+static bool     is_baud_rate_confirmed[SUPPORT_USART_COUNT] = { 0 };
+
+
+static void     start_rx(uint32_t usart);
+static void     release_rx_frame(uint32_t usart);
+static void     update_rx_crc(uint32_t usart);
+static void     process_baud_rate_switch(uint32_t usart);
+static void     switch_baud_rate(uint32_t usart, uint32_t new_baud_rate);
+static bool     is_request_valid(const uint8_t* request, uint32_t size, uint16_t crc, modbus_port_statistic_t* statistic);
+static void     start_tx(uint32_t usart, uint32_t response_size);
+static void     update_handler_time_statistic(modbus_port_statistic_t* statistic, uint32_t handler_time);
+static void     increment_counter(uint16_t* counter);
 static uint32_t read_ram_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
 static uint32_t write_ram_command_handler(const uint8_t* request, uint16_t rq_size);
+static uint32_t read_ram_ranges_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
 static uint32_t read_eeprom_command_handler(const uint8_t* request, uint8_t* response, uint8_t rq_size, uint8_t* rs_size);
 static uint32_t write_eeprom_command_handler(const uint8_t* request, uint16_t rq_size);
-static uint16_t calculate_crc16(const uint8_t* data, uint32_t size);
+static uint32_t set_baud_rate_command_handler(uint32_t usart, const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
+static uint32_t teleop_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
+static uint32_t joint_stream_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
+static uint32_t foot_targets_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
+static uint32_t time_sync_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size);
 
 
 //  ***************************************************************************
@@ -102,8 +138,11 @@ static uint16_t calculate_crc16(const uint8_t* data, uint32_t size);
 void modbus_init(void) {
     
     for (uint32_t i = 0; i < SUPPORT_USART_COUNT; ++i) {
-        usarts[i].usart_init(USART_BAUD_RATE);
-        usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
+        usart_pdc_init(&usarts[i], USART_BAUD_RATE);
+        baud_rate[i] = USART_BAUD_RATE;
+        pending_baud_rate[i] = 0;
+        is_baud_rate_confirmed[i] = true;
+        start_rx(i);
     }
 }
 
@@ -116,124 +155,336 @@ void modbus_process(void) {
     for (uint32_t i = 0; i < SUPPORT_USART_COUNT; ++i) {
     
         // Check USART errors
-        if (usarts[i].usart_is_error() == true) {
-            usarts[i].usart_reset(true, true);
-            usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
-            continue;
-        }
-    
-        // Check frame received
-        if (usarts[i].usart_is_frame_received() == false) {
+        if (usart_pdc_is_error(&usarts[i]) == true) {
+            increment_counter(&modbus_statistic[i].usart_error_count);
+            usart_pdc_reset(&usarts[i], true, true);
+            start_rx(i);
             continue;
         }
-    
-        // Check complete transmit response
-        if (usarts[i].usart_is_tx_complete() == false) {
-            usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
-            continue;
-        }
-    
-        // Verify frame
-        const uint8_t* request = usarts[i].usart_get_internal_rx_buffer_address();
-        uint32_t request_size = usarts[i].usart_get_frame_size();
-        if (is_request_valid(request, request_size) == false) {
-            usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
-            continue;
-        }
-    
-        // Process command
-        uint8_t* response = usarts[i].usart_get_internal_tx_buffer_address();
-        uint8_t response_size = 0;
-        uint32_t result = MB_OK;
-
-        switch (request[1]) {
         
-            case MB_CMD_READ_RAM:
-                result = read_ram_command_handler(request, response, request_size, &response_size);
-                break;
-
-            case MB_CMD_WRITE_RAM:
-                result = write_ram_command_handler(request, request_size);
-                break;
+        // Apply requested baud rate or fall back to default
+        process_baud_rate_switch(i);
+        
+        // Process received frames in order while response can be transmitted
+        while (true) {
+            
+            // Calculate CRC for already received bytes
+            update_rx_crc(i);
         
-            case MB_CMD_READ_EEPROM:
-                result = read_eeprom_command_handler(request, response, request_size, &response_size);
+            // Check frame received
+            if (usart_pdc_is_frame_received(&usarts[i]) == false) {
                 break;
-
-            case MB_CMD_WRITE_EEPROM:
-                result = write_eeprom_command_handler(request, request_size);
+            }
+        
+            // Check complete transmit response. Frame stay in queue
+            if (usart_pdc_is_tx_complete(&usarts[i]) == false) {
+                if (is_tx_wait_counted[i] == false) {
+                    increment_counter(&modbus_statistic[i].tx_busy_count);
+                    is_tx_wait_counted[i] = true;
+                }
                 break;
-
-            default:
-                usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
+            }
+        
+            // Verify frame (fold bytes received after previous CRC update)
+            update_rx_crc(i);
+            const uint8_t* request = request_buffer[i];
+            uint32_t request_size = usart_pdc_get_frame_size(&usarts[i]);
+            if (request_size != rx_crc_size[i]) {
+                increment_counter(&modbus_statistic[i].bad_size_count);     // Frame too long or overwritten in RX ring
+                release_rx_frame(i);
                 continue;
-        }
-    
-        // Check result
-        if (result != MB_OK) {
+            }
+            if (is_request_valid(request, request_size, rx_crc[i], &modbus_statistic[i]) == false) {
+                release_rx_frame(i);
+                continue;
+            }
+            is_baud_rate_confirmed[i] = true;
         
-            if (result != MB_BAD_FRAME) {
+            // Process command
+            uint8_t* response = usart_pdc_get_tx_buffer(&usarts[i]);
+            uint8_t response_size = 0;
+            uint32_t result = MB_OK;
+            uint32_t handler_start_time = get_time_us();
+
+            switch (request[1]) {
             
-                // Make and send exception
-                response[1] = request[0] | 0x80;
-                response[2] = result;
+                case MB_CMD_TELEOP:
+                    result = teleop_command_handler(request, response, request_size, &response_size);
+                    break;
+                
+                case MB_CMD_JOINT_STREAM:
+                    result = joint_stream_command_handler(request, response, request_size, &response_size);
+                    break;
+                
+                case MB_CMD_FOOT_TARGETS:
+                    result = foot_targets_command_handler(request, response, request_size, &response_size);
+                    break;
+                
+                case MB_CMD_TIME_SYNC:
+                    result = time_sync_command_handler(request, response, request_size, &response_size);
+                    break;
+                
+                case MB_CMD_EMERGENCY_STOP:
+                    result = MB_OK;     // PWM already frozen by USART ISR - send acknowledge only
+                    break;
+                
+                case MB_CMD_READ_RAM:
+                    result = read_ram_command_handler(request, response, request_size, &response_size);
+                    break;
+
+                case MB_CMD_WRITE_RAM:
+                    result = write_ram_command_handler(request, request_size);
+                    break;
+
+                case MB_CMD_READ_RAM_RANGES:
+                    result = read_ram_ranges_command_handler(request, response, request_size, &response_size);
+                    break;
+            
+                case MB_CMD_READ_EEPROM:
+                    result = read_eeprom_command_handler(request, response, request_size, &response_size);
+                    break;
+
+                case MB_CMD_WRITE_EEPROM:
+                    result = write_eeprom_command_handler(request, request_size);
+                    break;
+
+                case MB_CMD_SET_BAUD_RATE:
+                    result = set_baud_rate_command_handler(i, request, response, request_size, &response_size);
+                    break;
+
+                default:
+                    increment_counter(&modbus_statistic[i].unknown_function_count);
+                    release_rx_frame(i);
+                    continue;
+            }
+            update_handler_time_statistic(&modbus_statistic[i], get_time_us() - handler_start_time);
             
-                uint16_t crc = calculate_crc16(response, response_size);
-                response[response_size++] = crc & 0xFF;
-                response[response_size++] = crc >> 8;
+            // Frame with bad size for command is counted as error only
+            if (result != MB_BAD_FRAME) {
+                increment_counter(&modbus_statistic[i].request_count);
+            }
+        
+            // Check result
+            if (result != MB_OK) {
             
-                usarts[i].usart_start_tx(response_size);
-                usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
+                if (result == MB_BAD_FRAME) {
+                    increment_counter(&modbus_statistic[i].bad_size_count);
+                }
+                else {
+                
+                    // Make and send exception
+                    response[0] = request[0];
+                    response[1] = request[1] | 0x80;
+                    response[2] = result;
+                    response_size = 3;
+                
+                    uint16_t crc = crc16_calculate(response, response_size);
+                    response[response_size++] = crc & 0xFF;
+                    response[response_size++] = crc >> 8;
+                
+                    increment_counter(&modbus_statistic[i].exception_count);
+                    start_tx(i, response_size);
+                }
+                release_rx_frame(i);
+                continue;
             }
-            continue;
+        
+            // Make response
+            response[0] = request[0];
+            response[1] = request[1];
+            response_size += 2;
+        
+            uint16_t crc = crc16_calculate(response, response_size);
+            response[response_size++] = crc & 0xFF;
+            response[response_size++] = crc >> 8;
+        
+            // Send response
+            start_tx(i, response_size);
+            release_rx_frame(i);
         }
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Start receive frames
+/// @param  usart: USART index
+/// @return none
+//  ***************************************************************************
+static void start_rx(uint32_t usart) {
     
-        // Make response
-        response[0] = request[0];
-        response[1] = request[1];
-        response_size += 2;
+    rx_crc[usart] = CRC16_INIT_VALUE;
+    rx_crc_size[usart] = 0;
+    usart_pdc_start_rx(&usarts[usart]);
+}
+
+//  ***************************************************************************
+/// @brief  Remove processed frame from receive queue
+/// @param  usart: USART index
+/// @return none
+//  ***************************************************************************
+static void release_rx_frame(uint32_t usart) {
     
-        uint16_t crc = calculate_crc16(response, response_size);
-        response[response_size++] = crc & 0xFF;
-        response[response_size++] = crc >> 8;
+    is_tx_wait_counted[usart] = false;
+    rx_crc[usart] = CRC16_INIT_VALUE;
+    rx_crc_size[usart] = 0;
+    usart_pdc_release_frame(&usarts[usart]);
+}
+
+//  ***************************************************************************
+/// @brief  Copy bytes received since previous call to request buffer and update CRC
+/// @note   Frame CRC is ready when frame timeout detected. Bytes out of
+///         request buffer are not copied
+/// @param  usart: USART index
+/// @return none
+//  ***************************************************************************
+static void update_rx_crc(uint32_t usart) {
     
-        // Send response
-        usarts[i].usart_start_tx(response_size);
-        usarts[i].usart_start_rx(USART0_USE_INTERNAL_BUFFER, 0);
+    uint32_t size = usart_pdc_get_frame_size(&usarts[usart]);
+    if (size > MB_MAX_REQUEST_SIZE) {
+        size = MB_MAX_REQUEST_SIZE;
+    }
+    
+    if (size > rx_crc_size[usart]) {
+        
+        uint8_t* data = &request_buffer[usart][rx_crc_size[usart]];
+        uint32_t bytes_count = size - rx_crc_size[usart];
+        if (usart_pdc_read_frame(&usarts[usart], rx_crc_size[usart], data, bytes_count) == false) {
+            return;     // RX ring overflow - USART will be reset
+        }
+        rx_crc[usart] = crc16_update(rx_crc[usart], data, bytes_count);
+        rx_crc_size[usart] = size;
     }
 }
 
+//  ***************************************************************************
+/// @brief  Process baud rate switch
+/// @note   Requested baud rate applied after response transmit complete.
+///         Default baud rate restored if valid frame is not received at new
+///         baud rate during BAUD_RATE_CONFIRM_TIMEOUT
+/// @param  usart: USART index
+/// @return none
+//  ***************************************************************************
+static void process_baud_rate_switch(uint32_t usart) {
+    
+    if (pending_baud_rate[usart] != 0 && usart_pdc_is_tx_complete(&usarts[usart]) == true) {
+        switch_baud_rate(usart, pending_baud_rate[usart]);
+        is_baud_rate_confirmed[usart] = false;
+    }
+    
+    if (is_baud_rate_confirmed[usart] == false && get_time_ms() - baud_rate_switch_time[usart] > BAUD_RATE_CONFIRM_TIMEOUT) {
+        switch_baud_rate(usart, USART_BAUD_RATE);
+        is_baud_rate_confirmed[usart] = true;
+    }
+}
 
-
-
+//  ***************************************************************************
+/// @brief  Switch baud rate
+/// @note   Not processed frames are dropped
+/// @param  usart: USART index
+/// @param  new_baud_rate: baud rate
+/// @return none
+//  ***************************************************************************
+static void switch_baud_rate(uint32_t usart, uint32_t new_baud_rate) {
+    
+    usart_pdc_set_baud_rate(&usarts[usart], new_baud_rate);
+    baud_rate[usart] = new_baud_rate;
+    pending_baud_rate[usart] = 0;
+    baud_rate_switch_time[usart] = get_time_ms();
+    start_rx(usart);
+}
 
 //  ***************************************************************************
 /// @brief  Check ModBus frame
 /// @param  request: ModBus request
 /// @param  size:  frame size
+/// @param  crc:  frame CRC16 (include CRC field)
 /// @return true - frame valid, false - frame invalid
 //  ***************************************************************************
-static bool is_request_valid(const uint8_t* request, uint32_t size) {
+static bool is_request_valid(const uint8_t* request, uint32_t size, uint16_t crc, modbus_port_statistic_t* statistic) {
     
     // Check frame size
     if (size < MB_MIN_REQUEST_SIZE) {
+        increment_counter(&statistic->bad_size_count);
         return false;
     }
     
     // Check device address
     if (request[0] != 0xFE && request[0] != 0x68) {
+        increment_counter(&statistic->bad_address_count);
         return false;
     }
     
     // Check CRC
-    uint16_t crc = calculate_crc16(request, size);
     if (crc != 0) {
+        increment_counter(&statistic->bad_crc_count);
         return false;
     }
     
     return true;
 }
 
+//  ***************************************************************************
+/// @brief  Start response transmit and update latency statistic
+/// @note   Call before release request frame
+/// @param  usart: USART index
+/// @param  response_size: response size
+/// @return none
+//  ***************************************************************************
+static void start_tx(uint32_t usart, uint32_t response_size) {
+    
+    uint32_t latency = get_time_us() - usart_pdc_get_frame_time(&usarts[usart]);
+    modbus_port_statistic_t* statistic = &modbus_statistic[usart];
+    
+    if (latency > statistic->latency_max) {
+        statistic->latency_max = (latency > 0xFFFF) ? 0xFFFF : latency;
+    }
+    
+    uint32_t bin = MODBUS_LATENCY_HIST_SIZE - 1;
+    if      (latency < 100)  bin = 0;
+    else if (latency < 500)  bin = 1;
+    else if (latency < 1000) bin = 2;
+    else if (latency < 5000) bin = 3;
+    increment_counter(&statistic->latency_hist[bin]);
+    
+    usart_pdc_start_tx(&usarts[usart], response_size);
+}
+
+//  ***************************************************************************
+/// @brief  Update command handler time statistic
+/// @param  statistic: port statistic
+/// @param  handler_time: handler execution time [us]
+/// @return none
+//  ***************************************************************************
+static void update_handler_time_statistic(modbus_port_statistic_t* statistic, uint32_t handler_time) {
+    
+    if (handler_time > statistic->handler_time_max) {
+        statistic->handler_time_max = (handler_time > 0xFFFF) ? 0xFFFF : handler_time;
+    }
+    
+    uint32_t bin = MODBUS_HANDLER_TIME_HIST_SIZE - 1;
+    if      (handler_time < 10)   bin = 0;
+    else if (handler_time < 50)   bin = 1;
+    else if (handler_time < 200)  bin = 2;
+    else if (handler_time < 1000) bin = 3;
+    increment_counter(&statistic->handler_time_hist[bin]);
+}
+
+//  ***************************************************************************
+/// @brief  Increment statistic counter with saturation
+/// @param  counter: pointer to counter
+/// @return none
+//  ***************************************************************************
+static void increment_counter(uint16_t* counter) {
+    
+    if (*counter != 0xFFFF) {
+        ++(*counter);
+    }
+}
+
 //  ***************************************************************************
 /// @brief  Function for processing ModBus read RAM command
 /// @param  request: ModBus request
@@ -290,8 +541,13 @@ static uint32_t write_ram_command_handler(const uint8_t* request, uint16_t rq_si
     uint16_t address = (request[2] << 8) | request[3];
     uint8_t bytes_count = request[4];
     
+    // Check request size by bytes count: header (5 bytes) + data + CRC (2 bytes)
+    if (rq_size != 5 + bytes_count + 2) {
+        return MB_BAD_FRAME;
+    }
+    
     // Check request parameters 
-    if (bytes_count == 0 || bytes_count > MAX_READ_RAM_SIZE) {
+    if (bytes_count == 0 || bytes_count > MAX_WRITE_RAM_SIZE) {
         return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
     }
 
@@ -303,6 +559,62 @@ static uint32_t write_ram_command_handler(const uint8_t* request, uint16_t rq_si
     return MB_OK;
 }
 
+//  ***************************************************************************
+/// @brief  Function for processing ModBus read several RAM ranges command
+/// @note   Request: [range count][address H][address L][bytes count]...
+///         Response: [total bytes count][range 1 data][range 2 data]...
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t read_ram_ranges_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size < MB_READ_RAM_RANGES_CMD_MIN_LENGTH) {
+        return MB_BAD_FRAME;
+    }
+    
+    // Check ranges count
+    uint8_t range_count = request[2];
+    if (range_count == 0 || range_count > MAX_READ_RAM_RANGE_COUNT) {
+        return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    if (rq_size < MB_READ_RAM_RANGES_CMD_MIN_LENGTH + (range_count - 1) * MB_READ_RAM_RANGE_DESCRIPTOR_SIZE) {
+        return MB_BAD_FRAME;
+    }
+    
+    // Process command
+    const uint8_t* range = &request[3];
+    uint32_t total_bytes_count = 0;
+    for (uint32_t i = 0; i < range_count; ++i) {
+        
+        // Parse range parameters
+        uint16_t address = (range[0] << 8) | range[1];
+        uint8_t bytes_count = range[2];
+        range += MB_READ_RAM_RANGE_DESCRIPTOR_SIZE;
+        
+        // Check range parameters
+        if (bytes_count == 0 || total_bytes_count + bytes_count > MAX_READ_RAM_SIZE) {
+            return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+        
+        // Append range data to response
+        if (ram_map_read(address, &response[3 + total_bytes_count], bytes_count) == false) {
+            return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        }
+        total_bytes_count += bytes_count;
+    }
+    
+    response[2] = total_bytes_count;
+    *rs_size += total_bytes_count + 1; // +1: response[2] = bytes_count;
+    
+    return MB_OK;
+}
+
 //  ***************************************************************************
 /// @brief  Function for processing ModBus read EEPROM command
 /// @param  request: ModBus request
@@ -356,8 +668,13 @@ static uint32_t write_eeprom_command_handler(const uint8_t* request, uint16_t rq
     uint16_t address = (request[2] << 8) | request[3];
     uint8_t bytes_count = request[4];
     
+    // Check request size by bytes count: header (5 bytes) + data + CRC (2 bytes)
+    if (rq_size != 5 + bytes_count + 2) {
+        return MB_BAD_FRAME;
+    }
+    
     // Check request parameters
-    if (bytes_count == 0 || bytes_count > MAX_READ_EEPROM_SIZE) {
+    if (bytes_count == 0 || bytes_count > MAX_WRITE_EEPROM_SIZE) {
         return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
     }
     
@@ -370,27 +687,152 @@ static uint32_t write_eeprom_command_handler(const uint8_t* request, uint16_t rq
 }
 
 //  ***************************************************************************
-/// @brief  Calculate ModBus frame CRC16
-/// @param  frame: ModBus frame
-/// @param  size:  frame size
-/// @return CRC16 value
-//  ***************************************************************************
-static uint16_t calculate_crc16(const uint8_t* frame, uint32_t size) {
-    
-    uint16_t crc16 = 0xFFFF;
-    uint16_t data = 0;
-    uint16_t k = 0;
-    
-    while (size--) {
-        crc16 ^= *frame++;
-        k = 8;
-        while (k--) {
-            data = crc16;
-            crc16 >>= 1;
-            if (data & 0x0001) {
-                crc16 ^= CRC16_POLYNOM;
-            }
-        }
+/// @brief  Function for processing ModBus set baud rate command
+/// @note   Request: [baud rate (4 bytes)], response: [baud rate (4 bytes)].
+///         Baud rate switched after response transmit
+/// @param  usart: USART index
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t set_baud_rate_command_handler(uint32_t usart, const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size < MB_SET_BAUD_RATE_CMD_MIN_LENGTH) {
+        return MB_BAD_FRAME;
+    }
+    
+    // Parse request parameters
+    uint32_t new_baud_rate = (request[2] << 24) | (request[3] << 16) | (request[4] << 8) | request[5];
+    
+    // Check request parameters
+    if (new_baud_rate < USART_MIN_BAUD_RATE || new_baud_rate > USART_MAX_BAUD_RATE) {
+        return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    if (usart_pdc_is_baud_rate_supported(new_baud_rate) == false) {
+        return MB_EXCEPTION_ILLEGAL_DATA_VALUE;     // Divider error too large, host would lose sync
+    }
+    
+    // Process command
+    if (new_baud_rate != baud_rate[usart]) {
+        pending_baud_rate[usart] = new_baud_rate;
+    }
+    
+    memcpy(&response[2], &request[2], 4);
+    *rs_size += 4;
+    
+    return MB_OK;
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing teleoperation command
+/// @note   Request: [sequence][mode][speed][turn][height], response: [sequence]
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t teleop_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size != MB_TELEOP_CMD_LENGTH) {
+        return MB_BAD_FRAME;
     }
-    return crc16;
+    
+    // Process command
+    if (teleop_process_command(&request[2]) == false) {
+        return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    
+    response[2] = request[2];
+    *rs_size += 1;
+    
+    return MB_OK;
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing joint angles stream frame
+/// @note   Request: [timestamp][angles x 18], response: [jitter buffer level]
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t joint_stream_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size != MB_JOINT_STREAM_CMD_LENGTH) {
+        return MB_BAD_FRAME;
+    }
+    
+    // Push frame to jitter buffer. Overflow - host should slow down
+    if (joint_stream_push_frame(&request[2]) == false) {
+        return MB_EXCEPTION_SLAVE_DEV_FAILURE;
+    }
+    
+    response[2] = joint_stream_buffer_level;
+    *rs_size += 1;
+    
+    return MB_OK;
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing foot targets stream frame
+/// @note   Request: [sequence][X, Y, Z x 6], response: [sequence][error mask]
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t foot_targets_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size != MB_FOOT_TARGETS_CMD_LENGTH) {
+        return MB_BAD_FRAME;
+    }
+    
+    // Process frame. Movement in progress - targets can't be applied
+    if (foot_target_process_frame(&request[2], &response[2]) == false) {
+        return MB_EXCEPTION_SLAVE_DEV_FAILURE;
+    }
+    *rs_size += FOOT_TARGET_RESPONSE_SIZE;
+    
+    return MB_OK;
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing time synchronization command
+/// @note   Request: [T1][T4 of previous exchange], response: [T1][T2][T3][offset][delay]
+/// @param  request: ModBus request
+/// @param  response ModBus response
+/// @param  rq_size  request size
+/// @param  rs_size  response size
+/// @retval response
+/// @retval rs_size
+/// @return command process result
+//  ***************************************************************************
+static uint32_t time_sync_command_handler(const uint8_t* request, uint8_t* response, uint16_t rq_size, uint8_t* rs_size) {
+    
+    // Check request size
+    if (rq_size != MB_TIME_SYNC_CMD_LENGTH) {
+        return MB_BAD_FRAME;
+    }
+    
+    time_sync_process_request(&request[2], &response[2]);
+    *rs_size += TIME_SYNC_RESPONSE_SIZE;
+    
+    return MB_OK;
 }
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include "error_handling.h"
 #include "systimer.h"
 
+#define MAX_STATE_TRANSITIONS_PER_CALL      (8)
+
 
 typedef enum {
     STATE_NOINIT,           // Module not initialized
@@ -88,81 +90,89 @@ void movement_engine_process(void) {
 
     static sequence_stage_t sequence_stage = SEQUENCE_STAGE_PREPARE;
     static uint32_t current_iteration = 0;
-
-    switch (driver_state) {
-        
-        case STATE_IDLE:
-            if (current_sequence != next_sequence) {
-                driver_state = STATE_CHANGE_SEQUENCE;
-            }
-            break;
-        
-        case STATE_MOVE:
-            limbs_driver_set_smooth_config(current_sequence_info->iteration_list[current_iteration].smooth_point_count);
-            for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
-                limbs_driver_start_move(current_sequence_info->iteration_list[current_iteration].point_list, 
-                                        current_sequence_info->iteration_list[current_iteration].path_list);
-            }
-            driver_state = STATE_WAIT;
-            break;
+    
+    // Process state transitions until state is stable. Module called once per
+    // frame and each transition should not take separate frame
+    driver_state_t prev_driver_state = STATE_NOINIT;
+    uint32_t transition_count = 0;
+    do {
+        prev_driver_state = driver_state;
         
-        case STATE_WAIT:
-            if (limbs_driver_is_move_complete() == true) {
-                driver_state = STATE_NEXT_ITERATION;
-            }
-            break;
+        switch (driver_state) {
             
-        case STATE_NEXT_ITERATION:
+            case STATE_IDLE:
+                if (current_sequence != next_sequence) {
+                    driver_state = STATE_CHANGE_SEQUENCE;
+                }
+                break;
             
-            ++current_iteration;
-            driver_state = STATE_MOVE;
+            case STATE_MOVE:
+                limbs_driver_set_smooth_config(current_sequence_info->iteration_list[current_iteration].smooth_point_count);
+                for (uint32_t i = 0; i < SUPPORT_LIMB_COUNT; ++i) {
+                    limbs_driver_start_move(current_sequence_info->iteration_list[current_iteration].point_list, 
+                                            current_sequence_info->iteration_list[current_iteration].path_list);
+                }
+                driver_state = STATE_WAIT;
+                break;
             
-            if (sequence_stage == SEQUENCE_STAGE_PREPARE && current_iteration >= current_sequence_info->main_sequence_begin) {
-                sequence_stage = SEQUENCE_STAGE_MAIN;
-            }
-            if (sequence_stage == SEQUENCE_STAGE_MAIN && current_iteration >= current_sequence_info->finalize_sequence_begin) {
+            case STATE_WAIT:
+                if (limbs_driver_is_move_complete() == true) {
+                    driver_state = STATE_NEXT_ITERATION;
+                }
+                break;
                 
-                if (current_sequence != next_sequence) { 
-                    
-                    // Need change current sequence - go to finalize sequence if it available
-                    current_iteration = current_sequence_info->finalize_sequence_begin;
-                    sequence_stage = SEQUENCE_STAGE_FINALIZE;
+            case STATE_NEXT_ITERATION:
+                
+                ++current_iteration;
+                driver_state = STATE_MOVE;
+                
+                if (sequence_stage == SEQUENCE_STAGE_PREPARE && current_iteration >= current_sequence_info->main_sequence_begin) {
+                    sequence_stage = SEQUENCE_STAGE_MAIN;
                 }
-                else {
+                if (sequence_stage == SEQUENCE_STAGE_MAIN && current_iteration >= current_sequence_info->finalize_sequence_begin) {
                     
-                    if (current_sequence_info->is_sequence_looped == true) {
-                        current_iteration = current_sequence_info->main_sequence_begin;
+                    if (current_sequence != next_sequence) { 
+                        
+                        // Need change current sequence - go to finalize sequence if it available
+                        current_iteration = current_sequence_info->finalize_sequence_begin;
+                        sequence_stage = SEQUENCE_STAGE_FINALIZE;
                     }
                     else {
-                        // Current sequence completed and new sequence not selected
-                        hexapod_state = (current_sequence == SEQUENCE_DOWN) ? HEXAPOD_STATE_DOWN : HEXAPOD_STATE_UP;
-                        movement_engine_select_sequence(SEQUENCE_NONE);
-                        driver_state = STATE_CHANGE_SEQUENCE;
-                    }
-                }              
-            }
-            if (sequence_stage == SEQUENCE_STAGE_FINALIZE && current_iteration >= current_sequence_info->total_iteration_count) {
-                driver_state = STATE_CHANGE_SEQUENCE;
-            }           
-            break;
-            
-        case STATE_CHANGE_SEQUENCE:
-            current_sequence      = next_sequence;
-            current_sequence_info = next_sequence_info;
-            current_iteration     = 0;
-            sequence_stage        = SEQUENCE_STAGE_PREPARE;
-            driver_state          = STATE_MOVE;
-            
-            if (current_sequence == SEQUENCE_NONE) {
-                driver_state = STATE_IDLE;
-            }        
-            break;
-            
-        case STATE_NOINIT:
-        default:
-            callback_set_internal_error(ERROR_MODULE_MOVEMENT_ENGINE);
-            break;
-    }
+                        
+                        if (current_sequence_info->is_sequence_looped == true) {
+                            current_iteration = current_sequence_info->main_sequence_begin;
+                        }
+                        else {
+                            // Current sequence completed and new sequence not selected
+                            hexapod_state = (current_sequence == SEQUENCE_DOWN) ? HEXAPOD_STATE_DOWN : HEXAPOD_STATE_UP;
+                            movement_engine_select_sequence(SEQUENCE_NONE);
+                            driver_state = STATE_CHANGE_SEQUENCE;
+                        }
+                    }              
+                }
+                if (sequence_stage == SEQUENCE_STAGE_FINALIZE && current_iteration >= current_sequence_info->total_iteration_count) {
+                    driver_state = STATE_CHANGE_SEQUENCE;
+                }           
+                break;
+                
+            case STATE_CHANGE_SEQUENCE:
+                current_sequence      = next_sequence;
+                current_sequence_info = next_sequence_info;
+                current_iteration     = 0;
+                sequence_stage        = SEQUENCE_STAGE_PREPARE;
+                driver_state          = STATE_MOVE;
+                
+                if (current_sequence == SEQUENCE_NONE) {
+                    driver_state = STATE_IDLE;
+                }        
+                break;
+                
+            case STATE_NOINIT:
+            default:
+                callback_set_internal_error(ERROR_MODULE_MOVEMENT_ENGINE);
+                return;
+        }
+    } while (driver_state != prev_driver_state && ++transition_count < MAX_STATE_TRANSITIONS_PER_CALL);
     
 	// Reset height after down
     if (hexapod_state == HEXAPOD_STATE_DOWN && hexapod_height != GAIT_SEQUENCE_HEIGHT_LOW_LIMIT) {
@@ -209,6 +219,27 @@ void movement_engine_decrease_height(void) {
     movement_engine_select_sequence(SEQUENCE_UPDATE_HEIGHT);
 }
 
+//  ***************************************************************************
+/// @brief  Set hexapod height
+/// @param  height: new height (limited by sequences height limits)
+/// @return none
+//  ***************************************************************************
+void movement_engine_set_height(int32_t height) {
+    
+    if (height < GAIT_SEQUENCE_HEIGHT_LOW_LIMIT) {
+        height = GAIT_SEQUENCE_HEIGHT_LOW_LIMIT;
+    }
+    if (height > GAIT_SEQUENCE_HEIGHT_HIGH_LIMIT) {
+        height = GAIT_SEQUENCE_HEIGHT_HIGH_LIMIT;
+    }
+    if (height == hexapod_height) {
+        return;
+    }
+    
+    hexapod_height = height;
+    movement_engine_select_sequence(SEQUENCE_UPDATE_HEIGHT);
+}
+
 //  ***************************************************************************
 /// @brief  Select sequence
 /// @param  sequence: new sequence
@@ -0,0 +1,77 @@
+//  ***************************************************************************
+/// @file    multimedia.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "multimedia.h"
+
+#include <sam.h>
+#include <string.h>
+#include "ssd1306_128x64.h"
+#include "trajectory.h"
+
+#define OLED_ROW_COUNT                      (DISPLAY_HEIGHT / 8)
+#define OLED_SNAPSHOT_SIZE                  (OLED_ROW_COUNT * DISPLAY_WIDTH)
+
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t size;
+} blob_info_t;
+
+
+// Display content changes during transfer - chunks are read from snapshot
+static uint8_t oled_snapshot[OLED_SNAPSHOT_SIZE] = { 0 };
+
+static const blob_info_t blobs[] = {
+    { .data = oled_snapshot,                        .size = sizeof(oled_snapshot)     },    // MULTIMEDIA_BLOB_OLED_FRAME_BUFFER
+    { .data = (const uint8_t*)trajectory_buffer,    .size = sizeof(trajectory_buffer) }     // MULTIMEDIA_BLOB_TRAJECTORY
+};
+
+#define BLOB_COUNT                          (sizeof(blobs) / sizeof(blobs[0]))
+
+
+//  ***************************************************************************
+/// @brief  Get blob size and prepare blob for transfer
+/// @note   Call before read blob chunks. OLED frame buffer snapshot is
+///         captured here, so all chunks belong to one frame
+/// @param  blob_id: blob ID
+/// @param  size: blob size
+/// @return true - success, false - unknown blob
+//  ***************************************************************************
+bool multimedia_get_blob_size(uint32_t blob_id, uint32_t* size) {
+
+    if (blob_id >= BLOB_COUNT) {
+        return false;
+    }
+
+    if (blob_id == MULTIMEDIA_BLOB_OLED_FRAME_BUFFER) {
+        for (uint32_t row = 0; row < OLED_ROW_COUNT; ++row) {
+            memcpy(&oled_snapshot[row * DISPLAY_WIDTH], ssd1306_128x64_get_frame_buffer(row, 0), DISPLAY_WIDTH);
+        }
+    }
+
+    *size = blobs[blob_id].size;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Read blob chunk
+/// @note   Transfer can be resumed from any offset
+/// @param  blob_id: blob ID
+/// @param  offset: chunk offset
+/// @param  buffer: pointer to buffer
+/// @param  bytes_count: max chunk size
+/// @return chunk size, 0 - unknown blob or offset out of blob
+//  ***************************************************************************
+uint32_t multimedia_read(uint32_t blob_id, uint32_t offset, uint8_t* buffer, uint32_t bytes_count) {
+
+    if (blob_id >= BLOB_COUNT || offset >= blobs[blob_id].size) {
+        return 0;
+    }
+
+    if (bytes_count > blobs[blob_id].size - offset) {
+        bytes_count = blobs[blob_id].size - offset;
+    }
+    memcpy(buffer, &blobs[blob_id].data[offset], bytes_count);
+    return bytes_count;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+//  ***************************************************************************
+/// @file    profiler.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "profiler.h"
+
+#include <sam.h>
+#include "systimer.h"
+
+#define AVG_FILTER_SHIFT                    (4)     // Average by last ~16 runs
+#define LOOP_FREQUENCY_MEAS_PERIOD          (1000)  // ms
+
+
+uint16_t profiler_loop_frequency = 0;                                       // Read only
+profiler_statistic_t profiler_statistic[SUPPORT_TASK_COUNT] = { 0 };        // Read only
+
+static uint32_t avg_acc[SUPPORT_TASK_COUNT] = { 0 };
+static uint32_t loop_count = 0;
+static uint32_t loop_meas_start_time = 0;
+
+
+//  ***************************************************************************
+/// @brief  Reset profiler statistic
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void profiler_reset(void) {
+    
+    for (uint32_t i = 0; i < SUPPORT_TASK_COUNT; ++i) {
+        
+        profiler_statistic[i].min = 0xFFFF;
+        profiler_statistic[i].avg = 0;
+        profiler_statistic[i].max = 0;
+        for (uint32_t a = 0; a < PROFILER_HIST_SIZE; ++a) {
+            profiler_statistic[i].hist[a] = 0;
+        }
+        avg_acc[i] = 0;
+    }
+    
+    profiler_loop_frequency = 0;
+    loop_count = 0;
+    loop_meas_start_time = get_time_ms();
+}
+
+//  ***************************************************************************
+/// @brief  Profiler loop process
+/// @note   Call once per scheduler pass
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void profiler_loop_process(void) {
+    
+    ++loop_count;
+    
+    if (get_time_ms() - loop_meas_start_time >= LOOP_FREQUENCY_MEAS_PERIOD) {
+        profiler_loop_frequency = (loop_count > 0xFFFF) ? 0xFFFF : loop_count;
+        loop_count = 0;
+        loop_meas_start_time = get_time_ms();
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Update task execution time statistic
+/// @param  id: task ID @ref task_id_t
+/// @param  exec_time: task execution time [us]
+/// @return none
+//  ***************************************************************************
+void profiler_task_complete(task_id_t id, uint32_t exec_time) {
+    
+    if (id >= SUPPORT_TASK_COUNT) {
+        return;
+    }
+    
+    profiler_statistic_t* statistic = &profiler_statistic[id];
+    if (exec_time > 0xFFFF) {
+        exec_time = 0xFFFF;
+    }
+    
+    if (exec_time < statistic->min) {
+        statistic->min = exec_time;
+    }
+    if (exec_time > statistic->max) {
+        statistic->max = exec_time;
+    }
+    
+    avg_acc[id] = avg_acc[id] - (avg_acc[id] >> AVG_FILTER_SHIFT) + exec_time;
+    statistic->avg = avg_acc[id] >> AVG_FILTER_SHIFT;
+    
+    uint32_t bin = PROFILER_HIST_SIZE - 1;
+    if      (exec_time < 100)  bin = 0;
+    else if (exec_time < 1000) bin = 1;
+    if (statistic->hist[bin] != 0xFFFF) {
+        ++statistic->hist[bin];
+    }
+}
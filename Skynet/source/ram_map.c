@@ -6,82 +6,134 @@
 
 #include <sam.h>
 #include <stdlib.h>
+#include <string.h>
 #include "limbs_driver.h"
 #include "monitoring.h"
 #include "orientation.h"
+#include "pwm.h"
 #include "scr.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "control_loop.h"
+#include "teleop.h"
+#include "joint_stream.h"
+#include "foot_target.h"
+#include "trajectory.h"
+#include "time_sync.h"
+#include "veeprom.h"
+#include "modbus.h"
 #include "error_handling.h"
 #include "version.h"
         
-#define RAM_PUT_BYTE(ram_addr, var)  .data[ram_addr] = (uint8_t*)&(var)
+#define RAM_MAP_EXT_TASK_COUNT          (32)        // Tasks from TASK_ID_WIRELESS_MODBUS in statistic regions 0x0300 - 0x04BF
 
-#define RAM_PUT_WORD(ram_addr, var)  .data[(ram_addr) + 0] = ((uint8_t*)&(var)) + 1,    \
-                                     .data[(ram_addr) + 1] = ((uint8_t*)&(var)) + 0
+#define RAM_ACCESS_READ                 (0x01)
+#define RAM_ACCESS_WRITE                (0x02)
+#define RAM_ACCESS_RW                   (RAM_ACCESS_READ | RAM_ACCESS_WRITE)
 
-#define RAM_PUT_DWORD(ram_addr, var) .data[(ram_addr) + 0] = ((uint8_t*)&(var)) + 3,    \
-                                     .data[(ram_addr) + 1] = ((uint8_t*)&(var)) + 2,    \
-                                     .data[(ram_addr) + 2] = ((uint8_t*)&(var)) + 1,    \
-                                     .data[(ram_addr) + 3] = ((uint8_t*)&(var)) + 0
+// Region of variables or array elements of same size. Multibyte elements
+// mapped in big-endian byte order
+#define RAM_PUT_REGION(ram_addr, ptr, elem_size, count, acc)  { .address = (ram_addr), .size = (elem_size) * (count), .element_size = (elem_size), .access = (acc), .data = (uint8_t*)(ptr) }
+
+#define RAM_PUT_BYTE(ram_addr, var, acc)            RAM_PUT_REGION(ram_addr, &(var), 1, 1, acc)
+#define RAM_PUT_WORD(ram_addr, var, acc)            RAM_PUT_REGION(ram_addr, &(var), 2, 1, acc)
+#define RAM_PUT_DWORD(ram_addr, var, acc)           RAM_PUT_REGION(ram_addr, &(var), 4, 1, acc)
+#define RAM_PUT_BYTES(ram_addr, ptr, count, acc)    RAM_PUT_REGION(ram_addr, ptr, 1, count, acc)
+#define RAM_PUT_WORDS(ram_addr, ptr, count, acc)    RAM_PUT_REGION(ram_addr, ptr, 2, count, acc)
 
 typedef struct {
-    uint8_t* data[RAM_MAP_SIZE];
-} ram_map_t;
+    uint16_t address;                   // First RAM address of region
+    uint16_t size;                      // Region size [bytes]
+    uint8_t  element_size;              // 1, 2 or 4 bytes
+    uint8_t  access;                    // RAM_ACCESS_xxx
+    uint8_t* data;                      // Pointer to first element
+} ram_region_t;
+
 
 static const uint32_t device_id = DEVICE_ID;
 static const uint8_t  memory_map_version = MEMORY_MAP_VERSION;
-static const ram_map_t ram_map = {
-    
-	RAM_PUT_DWORD(0x0000, device_id),
-    RAM_PUT_BYTE (0x000F, memory_map_version),
-    RAM_PUT_WORD (0x0010, error_status),
-    RAM_PUT_BYTE (0x0012, wireless_voltage),
-    RAM_PUT_BYTE (0x0013, sensors_voltage),
-    RAM_PUT_BYTE (0x0014, battery_voltage),
-	
-	RAM_PUT_DWORD(0x0016, current_orientation.front_distance),
-    
-    RAM_PUT_BYTE (0x0060, scr),
-    RAM_PUT_DWORD(0x0061, scr_argument),
-    
-    RAM_PUT_BYTE (0x00C0, ram_link_angles[0]),
-    RAM_PUT_BYTE (0x00C1, ram_link_angles[1]),
-    RAM_PUT_BYTE (0x00C2, ram_link_angles[2]),
-    RAM_PUT_BYTE (0x00C3, ram_link_angles[3]),
-    RAM_PUT_BYTE (0x00C4, ram_link_angles[4]),
-    RAM_PUT_BYTE (0x00C5, ram_link_angles[5]),
-    RAM_PUT_BYTE (0x00C6, ram_link_angles[6]),
-    RAM_PUT_BYTE (0x00C7, ram_link_angles[7]),
-    RAM_PUT_BYTE (0x00C8, ram_link_angles[8]),
-    RAM_PUT_BYTE (0x00C9, ram_link_angles[9]),
-    RAM_PUT_BYTE (0x00CA, ram_link_angles[10]),
-    RAM_PUT_BYTE (0x00CB, ram_link_angles[11]),
-    RAM_PUT_BYTE (0x00CC, ram_link_angles[12]),
-    RAM_PUT_BYTE (0x00CD, ram_link_angles[13]),
-    RAM_PUT_BYTE (0x00CE, ram_link_angles[14]),
-    RAM_PUT_BYTE (0x00CF, ram_link_angles[15]),
-    RAM_PUT_BYTE (0x00D0, ram_link_angles[16]),
-    RAM_PUT_BYTE (0x00D1, ram_link_angles[17]),
-    
-    RAM_PUT_BYTE (0x00E0, ram_link_angles_override[0]),
-    RAM_PUT_BYTE (0x00E1, ram_link_angles_override[1]),
-    RAM_PUT_BYTE (0x00E2, ram_link_angles_override[2]),
-    RAM_PUT_BYTE (0x00E3, ram_link_angles_override[3]),
-    RAM_PUT_BYTE (0x00E4, ram_link_angles_override[4]),
-    RAM_PUT_BYTE (0x00E5, ram_link_angles_override[5]),
-    RAM_PUT_BYTE (0x00E6, ram_link_angles_override[6]),
-    RAM_PUT_BYTE (0x00E7, ram_link_angles_override[7]),
-    RAM_PUT_BYTE (0x00E8, ram_link_angles_override[8]),
-    RAM_PUT_BYTE (0x00E9, ram_link_angles_override[9]),
-    RAM_PUT_BYTE (0x00EA, ram_link_angles_override[10]),
-    RAM_PUT_BYTE (0x00EB, ram_link_angles_override[11]),
-    RAM_PUT_BYTE (0x00EC, ram_link_angles_override[12]),
-    RAM_PUT_BYTE (0x00ED, ram_link_angles_override[13]),
-    RAM_PUT_BYTE (0x00EE, ram_link_angles_override[14]),
-    RAM_PUT_BYTE (0x00EF, ram_link_angles_override[15]),
-    RAM_PUT_BYTE (0x00F0, ram_link_angles_override[16]),
-    RAM_PUT_BYTE (0x00F1, ram_link_angles_override[17])
+
+// Regions must be sorted by address and must not overlap
+static const ram_region_t ram_map[] = {
+    
+    RAM_PUT_DWORD(0x0000, device_id,                                RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x000F, memory_map_version,                       RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0010, error_status,                             RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0012, wireless_voltage,                         RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0013, sensors_voltage,                          RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0014, battery_voltage,                          RAM_ACCESS_READ),
+    
+    RAM_PUT_DWORD(0x0016, current_orientation.front_distance,       RAM_ACCESS_READ),
+    
+    RAM_PUT_BYTE (0x0020, pwm_isr_density_peak,                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0021, pwm_isr_density_max,                      RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0022, pwm_frequency,                            RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0024, ram_limbs_calc_time_max,                  RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x0026, scheduler_missed_frame_count,             RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x002A, scheduler_recovery_count,                 RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x002C, scheduler_degraded_mode,                  RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0030, control_loop_latency,                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0032, control_loop_latency_max,                 RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0036, teleop_latency,                           RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0038, teleop_latency_max,                       RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x003A, teleop_sequence,                          RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x003C, joint_stream_underrun_count,              RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x003E, joint_stream_drop_count,                  RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0040, joint_stream_buffer_level,                RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0042, foot_target_error_count,                  RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0044, foot_target_error_mask,                   RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x0046, time_sync_offset,                         RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x004A, time_sync_drift,                          RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x004E, time_sync_delay,                          RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0052, time_sync_sample_count,                   RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0054, teleop_actuation_latency,                 RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0056, teleop_actuation_latency_max,             RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0058, veeprom_flash_write_count,                RAM_ACCESS_READ),
+    
+    RAM_PUT_BYTE (0x0060, scr,                                      RAM_ACCESS_RW),
+    RAM_PUT_DWORD(0x0061, scr_argument,                             RAM_ACCESS_RW),
+    RAM_PUT_BYTE (0x0065, trajectory_type,                          RAM_ACCESS_RW),
+    RAM_PUT_BYTE (0x0066, trajectory_frame_period,                  RAM_ACCESS_RW),
+    RAM_PUT_BYTE (0x0067, trajectory_state,                         RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0068, trajectory_point_count,                   RAM_ACCESS_RW),
+    RAM_PUT_WORD (0x006A, trajectory_position,                      RAM_ACCESS_READ),
+    
+    RAM_PUT_BYTES(0x00C0, ram_link_angles, SUPPORT_LIMB_COUNT * 3,  RAM_ACCESS_READ),
+    RAM_PUT_BYTES(0x00E0, ram_link_angles_override, SUPPORT_LIMB_COUNT * 3, RAM_ACCESS_RW),
+    
+#ifdef PWM_ISR_STATISTIC_ENABLE
+    // pwm_isr_statistic_t contain only uint16_t fields (7 words)
+    RAM_PUT_WORDS(0x0100, pwm_isr_statistic, PWM_ISR_COUNT * sizeof(pwm_isr_statistic_t) / 2, RAM_ACCESS_READ),
+#endif
+    
+    // Tasks before TASK_ID_WIRELESS_MODBUS
+    RAM_PUT_WORDS(0x0164, scheduler_overrun_count, TASK_ID_WIRELESS_MODBUS, RAM_ACCESS_READ),
+    
+    RAM_PUT_WORD (0x017A, profiler_loop_frequency,                  RAM_ACCESS_READ),
+    
+    // profiler_statistic_t contain only uint16_t fields (6 words). Tasks before TASK_ID_WIRELESS_MODBUS
+    RAM_PUT_WORDS(0x017C, profiler_statistic, TASK_ID_WIRELESS_MODBUS * sizeof(profiler_statistic_t) / 2, RAM_ACCESS_READ),
+    
+    // modbus_port_statistic_t contain only uint16_t fields (20 words)
+    RAM_PUT_WORDS(0x0200, modbus_statistic, MODBUS_PORT_COUNT * sizeof(modbus_port_statistic_t) / 2, RAM_ACCESS_READ),
+    
+    // Tasks from TASK_ID_WIRELESS_MODBUS (continue 0x0164 region)
+    RAM_PUT_WORDS(0x0300, &scheduler_overrun_count[TASK_ID_WIRELESS_MODBUS], SUPPORT_TASK_COUNT - TASK_ID_WIRELESS_MODBUS, RAM_ACCESS_READ),
+    
+    // Tasks from TASK_ID_WIRELESS_MODBUS (continue 0x017C region)
+    RAM_PUT_WORDS(0x0340, &profiler_statistic[TASK_ID_WIRELESS_MODBUS], (SUPPORT_TASK_COUNT - TASK_ID_WIRELESS_MODBUS) * sizeof(profiler_statistic_t) / 2, RAM_ACCESS_READ),
+    
+    // Trajectory points (int16 values)
+    RAM_PUT_WORDS(0x1000, trajectory_buffer, TRAJECTORY_MAX_POINT_COUNT * TRAJECTORY_POINT_SIZE, RAM_ACCESS_RW)
 };
 
+#define RAM_MAP_REGION_COUNT            (sizeof(ram_map) / sizeof(ram_map[0]))
+
+_Static_assert(SUPPORT_TASK_COUNT - TASK_ID_WIRELESS_MODBUS <= RAM_MAP_EXT_TASK_COUNT, "Task statistic regions overlap");
+
+
+static const ram_region_t* find_region(uint32_t ram_address);
+
 
 //  ***************************************************************************
 /// @brief    Read RAM to external buffer
@@ -92,12 +144,46 @@ static const ram_map_t ram_map = {
 //  ***************************************************************************
 bool ram_map_read(uint32_t ram_address, uint8_t* buffer, uint32_t bytes_count) {
     
-    if (ram_address + bytes_count >= RAM_MAP_SIZE) {
+    if (ram_address + bytes_count > RAM_MAP_SIZE) {
         return false;    
     }
     
-    for (uint32_t i = 0; i < bytes_count; ++i) {
-        buffer[i] = (ram_map.data[ram_address + i] != NULL) ? *(ram_map.data[ram_address + i]) : 0;
+    uint32_t end_address = ram_address + bytes_count;
+    const ram_region_t* region = find_region(ram_address);
+    const ram_region_t* map_end = &ram_map[RAM_MAP_REGION_COUNT];
+    
+    while (ram_address < end_address) {
+        
+        // Unmapped bytes read as 0
+        uint32_t gap_end = (region != map_end && region->address < end_address) ? region->address : end_address;
+        if (ram_address < gap_end) {
+            memset(buffer, 0x00, gap_end - ram_address);
+            buffer += gap_end - ram_address;
+            ram_address = gap_end;
+            continue;
+        }
+        
+        // Copy region part
+        uint32_t offset = ram_address - region->address;
+        uint32_t region_end = region->address + region->size;
+        uint32_t count = ((region_end < end_address) ? region_end : end_address) - ram_address;
+        if ((region->access & RAM_ACCESS_READ) == 0) {
+            memset(buffer, 0x00, count);
+        }
+        else if (region->element_size == 1) {
+            memcpy(buffer, &region->data[offset], count);
+        }
+        else {
+            // Big-endian: XOR with (element_size - 1) reverse byte order in element
+            uint32_t swap_mask = region->element_size - 1;
+            for (uint32_t i = 0; i < count; ++i) {
+                buffer[i] = region->data[(offset + i) ^ swap_mask];
+            }
+        }
+        
+        buffer += count;
+        ram_address += count;
+        ++region;
     }
     
     return true;
@@ -105,23 +191,81 @@ bool ram_map_read(uint32_t ram_address, uint8_t* buffer, uint32_t bytes_count) {
 
 //  ***************************************************************************
 /// @brief  Write data to RAM from external buffer 
+/// @note   Writes to unmapped bytes ignored
 /// @param  ram_address: RAM address
 /// @param  buffer: pointer to buffer
 /// @param  bytes_count: bytes count for copy
-/// @return true - read data success, false - error
+/// @return true - read data success, false - error (out of map or region is read only)
 //  ***************************************************************************
 bool ram_map_write(uint32_t ram_address, const uint8_t* buffer, uint32_t bytes_count) {
     
-    if (ram_address + bytes_count >= RAM_MAP_SIZE) {
+    if (ram_address + bytes_count > RAM_MAP_SIZE) {
         return false;
     }
     
-    for (uint32_t i = 0; i < bytes_count; ++i) {
-
-        if (ram_map.data[ram_address + i] != NULL) {
-            *(ram_map.data[ram_address + i]) = buffer[i];
+    uint32_t end_address = ram_address + bytes_count;
+    const ram_region_t* first_region = find_region(ram_address);
+    const ram_region_t* map_end = &ram_map[RAM_MAP_REGION_COUNT];
+    
+    // Check access for all regions before write
+    for (const ram_region_t* region = first_region; region != map_end && region->address < end_address; ++region) {
+        if ((region->access & RAM_ACCESS_WRITE) == 0) {
+            return false;
         }
     }
     
+    for (const ram_region_t* region = first_region; region != map_end && region->address < end_address; ++region) {
+        
+        // Skip unmapped bytes
+        if (ram_address < region->address) {
+            buffer += region->address - ram_address;
+            ram_address = region->address;
+        }
+        
+        // Copy region part
+        uint32_t offset = ram_address - region->address;
+        uint32_t region_end = region->address + region->size;
+        uint32_t count = ((region_end < end_address) ? region_end : end_address) - ram_address;
+        if (region->element_size == 1) {
+            memcpy(&region->data[offset], buffer, count);
+        }
+        else {
+            uint32_t swap_mask = region->element_size - 1;
+            for (uint32_t i = 0; i < count; ++i) {
+                region->data[(offset + i) ^ swap_mask] = buffer[i];
+            }
+        }
+        
+        buffer += count;
+        ram_address += count;
+    }
+    
     return true;
 }
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Find first region which contain or follow RAM address
+/// @param  ram_address: RAM address
+/// @return Pointer to region or end of map
+//  ***************************************************************************
+static const ram_region_t* find_region(uint32_t ram_address) {
+    
+    // Binary search first region with end address > ram_address
+    uint32_t left = 0;
+    uint32_t right = RAM_MAP_REGION_COUNT;
+    while (left < right) {
+        
+        uint32_t middle = (left + right) / 2;
+        if (ram_map[middle].address + ram_map[middle].size <= ram_address) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    return &ram_map[left];
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+//  ***************************************************************************
+/// @file    scheduler.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "scheduler.h"
+
+#include <sam.h>
+#include <stdbool.h>
+#include "systimer.h"
+#include "profiler.h"
+
+#define DEGRADED_MODE_RECOVERY_FRAME_COUNT          (150)   // Frames without miss for exit from degraded mode
+
+
+uint16_t scheduler_overrun_count[SUPPORT_TASK_COUNT] = { 0 };    // Read only
+uint32_t scheduler_missed_frame_count = 0;                      // Read only
+uint16_t scheduler_recovery_count = 0;                          // Read only
+uint8_t  scheduler_degraded_mode = false;                       // Read only
+
+static volatile uint32_t frames_without_miss = 0;
+
+static const uint32_t task_period_ms[] = {
+    [TASK_PERIOD_1KHZ]       = 1,
+    [TASK_PERIOD_100HZ]      = 10,
+    [TASK_PERIOD_10HZ]       = 100,
+    [TASK_PERIOD_BACKGROUND] = 0
+};
+
+
+static bool is_task_ready(const scheduler_task_t* task);
+static void run_task(scheduler_task_t* task);
+
+
+//  ***************************************************************************
+/// @brief  Scheduler process (one pass over task list)
+/// @note   Task list order is task priority. Ready tasks run in list order.
+///         Sheddable tasks skipped while frames missed (degraded mode)
+/// @param  task_list: task list @ref scheduler_task_t
+/// @param  task_count: task count in list
+/// @return none
+//  ***************************************************************************
+void scheduler_process(scheduler_task_t* task_list, uint32_t task_count) {
+    
+    for (uint32_t i = 0; i < task_count; ++i) {
+        
+        scheduler_task_t* task = &task_list[i];
+        if (scheduler_degraded_mode == true && task->is_sheddable == true) {
+            continue;
+        }
+        
+        if (is_task_ready(task) == true) {
+            run_task(task);
+        }
+    }
+    
+    profiler_loop_process();
+}
+
+//  ***************************************************************************
+/// @brief  Update degraded mode state on control loop frame complete
+/// @note   Degraded mode enable on frame miss and disable after
+///         DEGRADED_MODE_RECOVERY_FRAME_COUNT frames without miss
+/// @param  missed_frame_count: frames missed before current frame
+/// @return none
+//  ***************************************************************************
+void scheduler_frame_complete(uint32_t missed_frame_count) {
+    
+    if (missed_frame_count != 0) {
+        scheduler_missed_frame_count += missed_frame_count;
+        scheduler_degraded_mode = true;
+        frames_without_miss = 0;
+        return;
+    }
+    
+    ++frames_without_miss;
+    if (scheduler_degraded_mode == true && frames_without_miss >= DEGRADED_MODE_RECOVERY_FRAME_COUNT) {
+        scheduler_degraded_mode = false;
+        ++scheduler_recovery_count;
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Check task ready for run
+/// @param  task: task info @ref scheduler_task_t
+/// @return true - task ready, false - no
+//  ***************************************************************************
+static bool is_task_ready(const scheduler_task_t* task) {
+    
+    switch (task->period) {
+        
+        case TASK_PERIOD_1KHZ:
+        case TASK_PERIOD_100HZ:
+        case TASK_PERIOD_10HZ:
+            return get_time_ms() - task->last_run >= task_period_ms[task->period];
+        
+        case TASK_PERIOD_BACKGROUND:
+        default:
+            return true;
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Run task and check execution time budget
+/// @param  task: task info @ref scheduler_task_t
+/// @return none
+//  ***************************************************************************
+static void run_task(scheduler_task_t* task) {
+    
+    task->last_run = get_time_ms();
+    
+    uint32_t start_cycles = get_time_cycles();
+    task->process();
+    uint32_t exec_time = (get_time_cycles() - start_cycles) / (SystemCoreClock / 1000000);
+    
+    if (exec_time > task->budget && scheduler_overrun_count[task->id] != 0xFFFF) {
+        ++scheduler_overrun_count[task->id];
+    }
+    profiler_task_complete(task->id, exec_time);
+}
@@ -12,6 +12,9 @@
 #include "gui.h"
 #include "led.h"
 #include "monitoring.h"
+#include "profiler.h"
+#include "control_loop.h"
+#include "trajectory.h"
 
 #define SCR_CMD_SELECT_SEQUENCE_UP                      (0x01)
 #define SCR_CMD_SELECT_SEQUENCE_DOWN                    (0x02)
@@ -28,12 +31,20 @@
 #define SCR_CMD_SELECT_SEQUENCE_ATTACK_RIGHT            (0x11)
 #define SCR_CMD_SELECT_SEQUENCE_DANCE                   (0x20)
 
+#define SCR_CMD_TRAJECTORY_PLAY                         (0x30)
+#define SCR_CMD_TRAJECTORY_PLAY_LOOP                    (0x31)
+#define SCR_CMD_TRAJECTORY_STOP                         (0x32)
+#define SCR_CMD_TRAJECTORY_SEEK                         (0x33)  // Argument: point index
+
 #define SCR_CMD_SELECT_SEQUENCE_INCREASE_HEIGHT         (0x88)
 #define SCR_CMD_SELECT_SEQUENCE_DECREASE_HEIGHT         (0x89)
 #define SCR_CMD_SELECT_SEQUENCE_NONE                    (0x90)
 
+#define SCR_CMD_RESET_PROFILER                          (0xF0)
+
+#define SCR_CMD_VEEPROM_COMMIT                          (0xFC)  // Write VEEPROM cache to flash
 #define SCR_CMD_CALCULATE_CHECKSUM                      (0xFD)
-#define SCR_CMD_RESET                                   (0xFE)
+#define SCR_CMD_RESET                                   (0xFE)  // VEEPROM cache is committed before reset
 
 
 uint8_t scr = 0;
@@ -46,6 +57,14 @@ int32_t scr_argument = 0;
 //  ***************************************************************************
 void scr_process(void) {
     
+    if (scr == 0x00) return;
+    
+    
+    // Flash write is not allowed under control loop lock
+    bool is_veeprom_commit_required = false;
+    bool is_reset_required = false;
+    
+    control_loop_lock();
     switch (scr) {
         
         case SCR_CMD_SELECT_SEQUENCE_UP:
@@ -103,6 +122,22 @@ void scr_process(void) {
             movement_engine_select_sequence(SEQUENCE_DANCE);
             break;
                 
+        case SCR_CMD_TRAJECTORY_PLAY:
+            trajectory_play(false);
+            break;
+            
+        case SCR_CMD_TRAJECTORY_PLAY_LOOP:
+            trajectory_play(true);
+            break;
+            
+        case SCR_CMD_TRAJECTORY_STOP:
+            trajectory_stop();
+            break;
+            
+        case SCR_CMD_TRAJECTORY_SEEK:
+            trajectory_seek(scr_argument);
+            break;
+                
         case SCR_CMD_SELECT_SEQUENCE_INCREASE_HEIGHT:
             movement_engine_increase_height();
             break;
@@ -115,14 +150,31 @@ void scr_process(void) {
             movement_engine_select_sequence(SEQUENCE_NONE);
             break;
         
+        case SCR_CMD_RESET_PROFILER:
+            profiler_reset();
+            break;
+        
+        case SCR_CMD_VEEPROM_COMMIT:
+            is_veeprom_commit_required = true;
+            break;
+        
         /*case SCR_CMD_CALCULATE_CHECKSUM:
             veeprom_update_checksum();
             break;*/
             
         case SCR_CMD_RESET:
-            REG_RSTC_CR = 0xA5000005;
+            is_veeprom_commit_required = true;
+            is_reset_required = true;
             break;
     }
+    control_loop_unlock();
+    
+    if (is_veeprom_commit_required == true) {
+        veeprom_commit();
+    }
+    if (is_reset_required == true) {
+        REG_RSTC_CR = 0xA5000005;
+    }
     
     scr = 0x00;
 }
\ No newline at end of file
@@ -31,6 +31,8 @@ typedef struct {
 
 
 static servo_info_t   servo_channels[SUPPORT_SERVO_COUNT] = { 0 };
+static uint32_t       pulse_stagger_step = 0;
+static uint32_t       pwm_frame_rate = PWM_DEFAULT_FREQUENCY_HZ;
 
 
 static bool read_configuration(void);
@@ -49,6 +51,11 @@ void servo_driver_init(void) {
     }
 
     pwm_init();
+    if (pwm_set_frequency(pwm_frame_rate) == false) {
+        callback_set_config_error(ERROR_MODULE_SERVO_DRIVER);
+        return;
+    }
+    pwm_set_pulse_stagger(pulse_stagger_step);
     pwm_enable();
     
     // Move servos to start position
@@ -121,7 +128,7 @@ void servo_driver_move(uint32_t ch, float angle) {
 
 //  ***************************************************************************
 /// @brief  Servo driver process
-/// @note   Call from main loop
+/// @note   Call from control loop (PendSV) once per frame
 //  ***************************************************************************
 void servo_driver_process(void) {
     
@@ -180,6 +187,21 @@ static bool read_configuration(void) {
             }
         }
     }
+    
+    // Read pulse start stagger step (not configured - all pulses start together)
+    pulse_stagger_step = veeprom_read_16(PWM_PULSE_STAGGER_STEP_EE_ADDRESS);
+    if (pulse_stagger_step == 0xFFFF) {
+        pulse_stagger_step = 0;
+    }
+    
+    // Read PWM frame rate (not configured - default frame rate)
+    pwm_frame_rate = veeprom_read_16(PWM_FREQUENCY_EE_ADDRESS);
+    if (pwm_frame_rate == 0xFFFF) {
+        pwm_frame_rate = PWM_DEFAULT_FREQUENCY_HZ;
+    }
+    if (pwm_frame_rate < PWM_MIN_FREQUENCY_HZ || pwm_frame_rate > PWM_MAX_FREQUENCY_HZ) {
+        return false;
+    }
 
     return true;
 }
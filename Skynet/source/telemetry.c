@@ -0,0 +1,192 @@
+//  ***************************************************************************
+/// @file    telemetry.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "telemetry.h"
+
+#include <sam.h>
+#include <string.h>
+#include "ram_map.h"
+#include "systimer.h"
+#include "control_loop.h"
+
+
+static wireless_ram_range_t ranges[TELEMETRY_MAX_RANGE_COUNT] = { 0 };
+static uint32_t range_count = 0;
+static uint32_t snapshot_size = 0;
+static uint32_t push_period = 0;                    // ms, 0 - telemetry disabled
+static uint32_t last_push_time = 0;
+static uint32_t sequence = 0;
+static uint32_t frames_to_keyframe = 0;
+
+static uint8_t  snapshot[2][TELEMETRY_MAX_SNAPSHOT_SIZE] = { 0 };
+static uint32_t current_snapshot = 0;
+
+
+static void     capture_snapshot(uint8_t* buffer);
+static uint32_t make_delta(const uint8_t* current, const uint8_t* previous, uint8_t* payload);
+
+
+//  ***************************************************************************
+/// @brief  Subscribe to telemetry
+/// @param  new_ranges: RAM ranges list
+/// @param  new_range_count: ranges count
+/// @param  period: push period [ms]
+/// @return true - success, false - bad ranges list or period
+//  ***************************************************************************
+bool telemetry_subscribe(const wireless_ram_range_t* new_ranges, uint32_t new_range_count, uint32_t period) {
+
+    telemetry_unsubscribe();
+
+    // Check parameters
+    if (period == 0 || new_range_count == 0 || new_range_count > TELEMETRY_MAX_RANGE_COUNT) {
+        return false;
+    }
+
+    uint32_t total_size = 0;
+    for (uint32_t i = 0; i < new_range_count; ++i) {
+
+        uint32_t address = new_ranges[i].address;
+        uint32_t bytes_count = new_ranges[i].bytes_count;
+        if (bytes_count == 0 || address + bytes_count > RAM_MAP_SIZE) {
+            return false;
+        }
+
+        total_size += bytes_count;
+        if (total_size > TELEMETRY_MAX_SNAPSHOT_SIZE) {
+            return false;
+        }
+    }
+
+    // Apply subscription. First frame is keyframe
+    memcpy(ranges, new_ranges, new_range_count * sizeof(wireless_ram_range_t));
+    range_count = new_range_count;
+    snapshot_size = total_size;
+    sequence = 0;
+    frames_to_keyframe = 0;
+    last_push_time = get_time_ms();
+    push_period = period;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Unsubscribe from telemetry
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void telemetry_unsubscribe(void) {
+
+    push_period = 0;
+    range_count = 0;
+    snapshot_size = 0;
+}
+
+//  ***************************************************************************
+/// @brief  Check telemetry frame push time
+/// @param  none
+/// @return true - need push frame, false - no
+//  ***************************************************************************
+bool telemetry_is_push_required(void) {
+
+    if (push_period == 0) {
+        return false;
+    }
+    return get_time_ms() - last_push_time >= push_period;
+}
+
+//  ***************************************************************************
+/// @brief  Make telemetry frame
+/// @note   Frame data contain telemetry_header_t and payload. Frame is variable
+///         size: CRC follow data[bytes_count]
+/// @param  frame: pointer to frame
+/// @return frame data size (frame->bytes_count)
+//  ***************************************************************************
+uint32_t telemetry_make_frame(wireless_frame_t* frame) {
+
+    last_push_time = get_time_ms();
+
+    uint8_t* current = snapshot[current_snapshot];
+    const uint8_t* previous = snapshot[current_snapshot ^ 1];
+    capture_snapshot(current);
+
+    telemetry_header_t* header = (telemetry_header_t*)frame->data;
+    uint8_t* payload = &frame->data[sizeof(telemetry_header_t)];
+    header->sequence = sequence++;
+    header->timestamp = get_time_us();
+    header->snapshot_size = snapshot_size;
+
+    // Make delta frame. Send keyframe if delta is not smaller than snapshot
+    uint32_t payload_size = snapshot_size;
+    if (frames_to_keyframe != 0) {
+        payload_size = make_delta(current, previous, payload);
+    }
+
+    if (payload_size < snapshot_size) {
+        header->type = TELEMETRY_FRAME_TYPE_DELTA;
+        --frames_to_keyframe;
+    }
+    else {
+        memcpy(payload, current, snapshot_size);
+        payload_size = snapshot_size;
+        header->type = TELEMETRY_FRAME_TYPE_KEYFRAME;
+        frames_to_keyframe = TELEMETRY_KEYFRAME_INTERVAL - 1;
+    }
+    current_snapshot ^= 1;
+
+    frame->function_code = WIRELESS_MODBUS_CMD_TELEMETRY;
+    frame->address = 0;
+    frame->bytes_count = sizeof(telemetry_header_t) + payload_size;
+    return frame->bytes_count;
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Capture subscribed RAM ranges
+/// @note   Control loop locked for consistent snapshot
+/// @param  buffer: snapshot buffer
+/// @return none
+//  ***************************************************************************
+static void capture_snapshot(uint8_t* buffer) {
+
+    control_loop_lock();
+    for (uint32_t i = 0; i < range_count; ++i) {
+        ram_map_read(ranges[i].address, buffer, ranges[i].bytes_count);
+        buffer += ranges[i].bytes_count;
+    }
+    control_loop_unlock();
+}
+
+//  ***************************************************************************
+/// @brief  Make delta payload
+/// @note   Payload: mask of changed bytes (bit per snapshot byte), changed bytes
+/// @param  current: current snapshot
+/// @param  previous: previous snapshot
+/// @param  payload: payload buffer
+/// @return payload size or snapshot size if delta is not smaller than snapshot
+//  ***************************************************************************
+static uint32_t make_delta(const uint8_t* current, const uint8_t* previous, uint8_t* payload) {
+
+    uint32_t mask_size = (snapshot_size + 7) / 8;
+    uint8_t* mask = payload;
+    uint8_t* data = &payload[mask_size];
+    memset(mask, 0x00, mask_size);
+
+    uint32_t payload_size = mask_size;
+    for (uint32_t i = 0; i < snapshot_size; ++i) {
+
+        if (current[i] != previous[i]) {
+
+            if (payload_size + 1 >= snapshot_size) {
+                return snapshot_size;
+            }
+
+            mask[i / 8] |= (1 << (i % 8));
+            *data++ = current[i];
+            ++payload_size;
+        }
+    }
+    return payload_size;
+}
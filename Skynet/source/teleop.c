@@ -0,0 +1,187 @@
+//  ***************************************************************************
+/// @file    teleop.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "teleop.h"
+
+#include <sam.h>
+#include <stdlib.h>
+#include "movement_engine.h"
+#include "control_loop.h"
+#include "systimer.h"
+#include "time_sync.h"
+
+#define LINK_TIMEOUT                        (500)   // ms, movement stopped if no command received
+#define SHORT_STEP_THRESHOLD                (50)    // |speed| or |turn| < threshold - short step sequences
+#define MAX_SPEED                           (100)
+
+
+uint16_t teleop_latency = 0;                // Read only
+uint16_t teleop_latency_max = 0;            // Read only
+uint8_t  teleop_sequence = 0;               // Read only
+uint16_t teleop_actuation_latency = 0;      // Read only
+uint16_t teleop_actuation_latency_max = 0;  // Read only
+
+static bool     is_first_command = true;
+static bool     is_movement_active = false;
+static uint32_t last_command_time = 0;
+
+static volatile bool     is_latency_measure_pending = false;
+static volatile uint32_t command_decode_time = 0;
+static volatile uint32_t command_send_time = 0;        // Local time of command transmit by host
+static volatile bool     is_send_time_valid = false;
+
+
+static sequence_id_t select_walk_sequence(int32_t speed, int32_t turn);
+static void update_latency(uint16_t* latency, uint16_t* latency_max, uint32_t value);
+
+
+//  ***************************************************************************
+/// @brief  Teleoperation process
+/// @note   Stop movement on link loss. Sequence number is reset too, so
+///         restarted host can begin from any sequence number
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void teleop_process(void) {
+
+    if (is_first_command == true || get_time_ms() - last_command_time <= LINK_TIMEOUT) {
+        return;
+    }
+
+    if (is_movement_active == true) {
+        control_loop_lock();
+        movement_engine_select_sequence(SEQUENCE_NONE);
+        control_loop_unlock();
+        is_movement_active = false;
+    }
+    is_first_command = true;
+    teleop_sequence = 0;
+}
+
+//  ***************************************************************************
+/// @brief  Decode teleoperation command and apply it to movement engine
+/// @note   Command: [sequence][mode][speed (int8)][turn (int8)][height (0 - keep)]
+///         [host timestamp (uint32, us, big-endian, 0 - unknown)].
+///         Height is applied when movement is stopped. Commands with old
+///         sequence number are ignored and don't hold the link
+/// @param  command: pointer to command
+/// @return true - command accepted, false - bad command
+//  ***************************************************************************
+bool teleop_process_command(const uint8_t* command) {
+
+    uint8_t sequence = command[0];
+    uint8_t mode     = command[1];
+    int32_t speed    = (int8_t)command[2];
+    int32_t turn     = (int8_t)command[3];
+    uint8_t height   = command[4];
+    uint32_t timestamp = (command[5] << 24) | (command[6] << 16) | (command[7] << 8) | command[8];
+
+    // Check parameters
+    if (mode > TELEOP_MODE_DANCE || abs(speed) > MAX_SPEED || abs(turn) > MAX_SPEED) {
+        return false;
+    }
+
+    // Skip reordered or duplicated command
+    if (is_first_command == false && (int8_t)(sequence - teleop_sequence) <= 0) {
+        return true;
+    }
+    is_first_command = false;
+    teleop_sequence = sequence;
+    last_command_time = get_time_ms();
+
+    // Apply command
+    sequence_id_t movement_sequence = SEQUENCE_NONE;
+    switch (mode) {
+        case TELEOP_MODE_WALK:          movement_sequence = select_walk_sequence(speed, turn); break;
+        case TELEOP_MODE_UP:            movement_sequence = SEQUENCE_UP;                       break;
+        case TELEOP_MODE_DOWN:          movement_sequence = SEQUENCE_DOWN;                     break;
+        case TELEOP_MODE_ATTACK_LEFT:   movement_sequence = SEQUENCE_ATTACK_LEFT;              break;
+        case TELEOP_MODE_ATTACK_RIGHT:  movement_sequence = SEQUENCE_ATTACK_RIGHT;             break;
+        case TELEOP_MODE_DANCE:         movement_sequence = SEQUENCE_DANCE;                    break;
+        default:                        movement_sequence = SEQUENCE_NONE;                     break;
+    }
+
+    control_loop_lock();
+    if (height != 0 && movement_sequence == SEQUENCE_NONE) {
+        movement_engine_set_height(height);
+    }
+    else {
+        movement_engine_select_sequence(movement_sequence);
+    }
+    command_decode_time = get_time_us();
+    is_send_time_valid = (timestamp != 0 && time_sync_is_valid() == true);
+    if (is_send_time_valid == true) {
+        command_send_time = time_sync_host_to_local(timestamp);
+    }
+    is_latency_measure_pending = true;
+    control_loop_unlock();
+
+    is_movement_active = (movement_sequence != SEQUENCE_NONE);
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Servo frame committed
+/// @note   Call from control loop after servo driver process
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void teleop_frame_committed(void) {
+
+    if (is_latency_measure_pending == false) {
+        return;
+    }
+    is_latency_measure_pending = false;
+
+    uint32_t current_time = get_time_us();
+    update_latency(&teleop_latency, &teleop_latency_max, current_time - command_decode_time);
+    if (is_send_time_valid == true) {
+        update_latency(&teleop_actuation_latency, &teleop_actuation_latency_max, current_time - command_send_time);
+    }
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Select walk sequence by speed and turn
+/// @note   Larger component selects sequence, its value selects step length
+/// @param  speed: forward speed (-100...100)
+/// @param  turn: rotation speed (-100...100, positive - right)
+/// @return sequence
+//  ***************************************************************************
+static sequence_id_t select_walk_sequence(int32_t speed, int32_t turn) {
+
+    if (speed == 0 && turn == 0) {
+        return SEQUENCE_NONE;
+    }
+
+    if (abs(turn) > abs(speed)) {
+        if (turn > 0) {
+            return (turn < SHORT_STEP_THRESHOLD) ? SEQUENCE_ROTATE_RIGHT_SHORT : SEQUENCE_ROTATE_RIGHT;
+        }
+        return (-turn < SHORT_STEP_THRESHOLD) ? SEQUENCE_ROTATE_LEFT_SHORT : SEQUENCE_ROTATE_LEFT;
+    }
+
+    if (speed > 0) {
+        return (speed < SHORT_STEP_THRESHOLD) ? SEQUENCE_DIRECT_MOVEMENT_SHORT : SEQUENCE_DIRECT_MOVEMENT;
+    }
+    return (-speed < SHORT_STEP_THRESHOLD) ? SEQUENCE_REVERSE_MOVEMENT_SHORT : SEQUENCE_REVERSE_MOVEMENT;
+}
+
+//  ***************************************************************************
+/// @brief  Update latency statistic
+/// @param  latency: pointer to last latency value
+/// @param  latency_max: pointer to max latency value
+/// @param  value: new latency [us]
+/// @return none
+//  ***************************************************************************
+static void update_latency(uint16_t* latency, uint16_t* latency_max, uint32_t value) {
+
+    *latency = (value > 0xFFFF) ? 0xFFFF : value;
+    if (*latency > *latency_max) {
+        *latency_max = *latency;
+    }
+}
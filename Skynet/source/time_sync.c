@@ -0,0 +1,167 @@
+//  ***************************************************************************
+/// @file    time_sync.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "time_sync.h"
+
+#include <sam.h>
+#include "control_loop.h"
+#include "systimer.h"
+
+#define OFFSET_FILTER_FACTOR                (4)             // New sample weight 1/N
+#define MAX_EXCESS_DELAY                    (500)           // us, samples with delay > 2 * min delay + N are skipped
+#define MIN_DRIFT_SPAN                      (10000000)      // us, min time between samples for drift estimation
+#define MAX_DRIFT_SPAN                      (1800000000)    // us, drift reference sample update time
+
+
+int32_t  time_sync_offset = 0;              // Read only
+int32_t  time_sync_drift = 0;               // Read only
+uint32_t time_sync_delay = 0;               // Read only
+uint16_t time_sync_sample_count = 0;        // Read only
+
+// Previous exchange timestamps. Host send receive time of response in next request
+static bool     is_prev_exchange_valid = false;
+static uint32_t prev_host_tx_time = 0;
+static uint32_t prev_local_rx_time = 0;
+static uint32_t prev_local_tx_time = 0;
+
+static uint32_t min_delay = 0xFFFFFFFF;
+static uint32_t offset_time = 0;            // Local time of offset estimation
+static uint32_t drift_reference_time = 0;
+static int32_t  drift_reference_offset = 0;
+
+
+static void add_sample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4);
+static int32_t get_offset(uint32_t local_time);
+
+
+//  ***************************************************************************
+/// @brief  Process time synchronization request
+/// @note   Request: [T1 - host transmit time][T4 - host receive time of
+///         previous response, 0 - unknown]. Response: [T1][T2 - local
+///         receive time][T3 - local transmit time][offset][round trip delay].
+///         All values is uint32 [us], big-endian. Previous exchange with T4
+///         give offset sample to local estimation (NTP interleaved mode)
+/// @param  request: pointer to request data
+/// @param  response: pointer to response data buffer
+/// @return none
+//  ***************************************************************************
+void time_sync_process_request(const uint8_t* request, uint8_t* response) {
+
+    uint32_t rx_time = get_time_us();
+    uint32_t host_tx_time = (request[0] << 24) | (request[1] << 16) | (request[2] << 8) | request[3];
+    uint32_t host_rx_time = (request[4] << 24) | (request[5] << 16) | (request[6] << 8) | request[7];
+
+    if (is_prev_exchange_valid == true && host_rx_time != 0) {
+        add_sample(prev_host_tx_time, prev_local_rx_time, prev_local_tx_time, host_rx_time);
+    }
+
+    uint32_t tx_time = get_time_us();
+    uint32_t values[5] = { host_tx_time, rx_time, tx_time, time_sync_offset, time_sync_delay };
+    for (uint32_t i = 0; i < 5; ++i) {
+        response[i * 4 + 0] = values[i] >> 24;
+        response[i * 4 + 1] = values[i] >> 16;
+        response[i * 4 + 2] = values[i] >> 8;
+        response[i * 4 + 3] = values[i];
+    }
+
+    prev_host_tx_time = host_tx_time;
+    prev_local_rx_time = rx_time;
+    prev_local_tx_time = tx_time;
+    is_prev_exchange_valid = true;
+}
+
+//  ***************************************************************************
+/// @brief  Check host clock synchronized
+/// @param  none
+/// @return true - offset estimated, false - no
+//  ***************************************************************************
+bool time_sync_is_valid(void) {
+    return time_sync_sample_count != 0;
+}
+
+//  ***************************************************************************
+/// @brief  Convert host time to local time
+/// @param  host_time: host time [us]
+/// @return local time [us]
+//  ***************************************************************************
+uint32_t time_sync_host_to_local(uint32_t host_time) {
+    return host_time + get_offset(host_time + time_sync_offset);
+}
+
+//  ***************************************************************************
+/// @brief  Convert local time to host time
+/// @param  local_time: local time [us]
+/// @return host time [us]
+//  ***************************************************************************
+uint32_t time_sync_local_to_host(uint32_t local_time) {
+    return local_time - get_offset(local_time);
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Add offset sample
+/// @note   Samples with queued request or response (large delay) are skipped
+/// @param  t1: host transmit time
+/// @param  t2: local receive time
+/// @param  t3: local transmit time
+/// @param  t4: host receive time
+/// @return none
+//  ***************************************************************************
+static void add_sample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+
+    int32_t round_trip = (int32_t)(t4 - t1) - (int32_t)(t3 - t2);
+    if (round_trip < 0) {
+        return;
+    }
+    uint32_t delay = round_trip;
+    if (delay < min_delay) {
+        min_delay = delay;
+    }
+    if (delay > 2 * min_delay + MAX_EXCESS_DELAY) {
+        return;
+    }
+    int32_t offset = ((int32_t)(t2 - t1) + (int32_t)(t3 - t4)) / 2;
+
+    control_loop_lock();
+
+    if (time_sync_sample_count == 0) {
+        time_sync_offset = offset;
+        drift_reference_time = t2;
+        drift_reference_offset = offset;
+    }
+    else {
+        int32_t predicted_offset = get_offset(t2);
+        time_sync_offset = predicted_offset + (offset - predicted_offset) / OFFSET_FILTER_FACTOR;
+
+        uint32_t span = t2 - drift_reference_time;
+        if (span >= MIN_DRIFT_SPAN) {
+            time_sync_drift = (int64_t)(time_sync_offset - drift_reference_offset) * 1000000000 / span;
+        }
+        if (span >= MAX_DRIFT_SPAN) {
+            drift_reference_time = t2;
+            drift_reference_offset = time_sync_offset;
+        }
+    }
+    offset_time = t2;
+    time_sync_delay = delay;
+    if (time_sync_sample_count < 0xFFFF) {
+        ++time_sync_sample_count;
+    }
+
+    control_loop_unlock();
+}
+
+//  ***************************************************************************
+/// @brief  Get offset for local time with drift correction
+/// @param  local_time: local time [us]
+/// @return offset [us]
+//  ***************************************************************************
+static int32_t get_offset(uint32_t local_time) {
+
+    int32_t elapsed = local_time - offset_time;
+    return time_sync_offset + (int64_t)time_sync_drift * elapsed / 1000000000;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+//  ***************************************************************************
+/// @file    trajectory.c
+/// @author  NeoProg
+//  ***************************************************************************
+#include "trajectory.h"
+
+#include <sam.h>
+#include "pwm.h"
+
+
+int16_t  trajectory_buffer[TRAJECTORY_MAX_POINT_COUNT][TRAJECTORY_POINT_SIZE] = { 0 };   // Read/Write
+uint8_t  trajectory_type = TRAJECTORY_TYPE_JOINTS;                                      // Read/Write
+uint8_t  trajectory_frame_period = 1;                                                   // Read/Write
+uint16_t trajectory_point_count = 0;                                                    // Read/Write
+uint8_t  trajectory_state = TRAJECTORY_STATE_STOPPED;                                   // Read only
+uint16_t trajectory_position = 0;                                                       // Read only
+
+static bool     is_loop_enabled = false;
+static uint32_t start_point = 0;
+static uint32_t start_synchro = 0;
+
+
+static bool is_configuration_valid(void);
+
+
+//  ***************************************************************************
+/// @brief  Start trajectory playback from current position
+/// @note   Call with locked control loop. First point is played on next
+///         PWM frame. Playback restart from begin if trajectory was finished
+/// @param  is_loop: true - loop playback, false - stop on last point
+/// @return true - playback started, false - bad trajectory configuration
+//  ***************************************************************************
+bool trajectory_play(bool is_loop) {
+
+    if (is_configuration_valid() == false) {
+        trajectory_state = TRAJECTORY_STATE_ERROR;
+        return false;
+    }
+
+    if (trajectory_position >= trajectory_point_count - 1) {
+        trajectory_position = 0;
+    }
+    is_loop_enabled = is_loop;
+    start_point = trajectory_position;
+    start_synchro = synchro + 1;
+    trajectory_state = TRAJECTORY_STATE_PLAYING;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Stop trajectory playback
+/// @note   Call with locked control loop. Position is saved
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void trajectory_stop(void) {
+
+    trajectory_state = TRAJECTORY_STATE_STOPPED;
+}
+
+//  ***************************************************************************
+/// @brief  Move playback position
+/// @note   Call with locked control loop. Point is played on next PWM frame
+///         if playback is active
+/// @param  point: new position
+/// @return true - success, false - point out of trajectory
+//  ***************************************************************************
+bool trajectory_seek(uint32_t point) {
+
+    if (point >= trajectory_point_count || point >= TRAJECTORY_MAX_POINT_COUNT) {
+        return false;
+    }
+
+    trajectory_position = point;
+    start_point = point;
+    start_synchro = synchro + 1;
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Abort playback by error
+/// @note   Call from control loop if point can't be played
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void trajectory_abort(void) {
+
+    trajectory_state = TRAJECTORY_STATE_ERROR;
+}
+
+//  ***************************************************************************
+/// @brief  Get trajectory point for current PWM frame
+/// @note   Call from control loop once per frame. Point is selected by
+///         synchro value, missed frames skip points
+/// @param  none
+/// @return pointer to point or NULL if playback is not active
+//  ***************************************************************************
+const int16_t* trajectory_get_point(void) {
+
+    if (trajectory_state != TRAJECTORY_STATE_PLAYING) {
+        return NULL;
+    }
+    if (is_configuration_valid() == false) {
+        trajectory_state = TRAJECTORY_STATE_ERROR;
+        return NULL;
+    }
+
+    // Playback starts on next frame after command
+    int32_t elapsed_frames = synchro - start_synchro;
+    if (elapsed_frames < 0) {
+        return NULL;
+    }
+
+    uint32_t point = start_point + elapsed_frames / trajectory_frame_period;
+    if (point >= trajectory_point_count) {
+
+        if (is_loop_enabled == true) {
+            point %= trajectory_point_count;
+        }
+        else {
+            point = trajectory_point_count - 1;
+            trajectory_state = TRAJECTORY_STATE_STOPPED;
+        }
+    }
+
+    trajectory_position = point;
+    return trajectory_buffer[point];
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief  Check trajectory configuration
+/// @param  none
+/// @return true - configuration valid, false - no
+//  ***************************************************************************
+static bool is_configuration_valid(void) {
+
+    if (trajectory_type != TRAJECTORY_TYPE_JOINTS && trajectory_type != TRAJECTORY_TYPE_FOOT_TARGETS) {
+        return false;
+    }
+    if (trajectory_point_count == 0 || trajectory_point_count > TRAJECTORY_MAX_POINT_COUNT) {
+        return false;
+    }
+    return trajectory_frame_period != 0;
+}
\ No newline at end of file
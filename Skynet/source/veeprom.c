@@ -5,7 +5,9 @@
 #include "veeprom.h"
 
 #include <sam.h>
+#include <string.h>
 #include "flash.h"
+#include "systimer.h"
 #include "error_handling.h"
 
 #define VEEPROM_BEGIN_ADDRESS           (0x0000)
@@ -20,8 +22,30 @@
 
 #define VEEPROM_FLASH_START_ADDRESS     (FLASH_BANK1_START_ADDRESS + (FLASH_BANK1_PAGE_COUNT - VEEPROM_PAGE_COUNT) * FLASH_PAGE_SIZE)
 
+#define VEEPROM_CACHE_PAGE_COUNT        (2)
+#define VEEPROM_CACHE_IDLE_TIMEOUT      (1000)      // ms, dirty pages flushed after last write
 
-static uint32_t calculate_checksum(void);
+
+typedef struct {
+    bool     is_valid;
+    bool     is_dirty;                      // Page changed and not written to flash
+    uint32_t page;                          // VEEPROM page number
+    uint32_t last_access_time;              // ms, least recently used page is evicted
+    uint8_t  data[VEEPROM_PAGE_SIZE];
+} cache_page_t;
+
+
+uint16_t veeprom_flash_write_count = 0;     // Read only: flash page writes
+
+
+static cache_page_t cache[VEEPROM_CACHE_PAGE_COUNT] = { 0 };
+static uint32_t last_write_time = 0;
+
+
+static uint32_t      calculate_checksum(void);
+static cache_page_t* find_cache_page(uint32_t page);
+static cache_page_t* load_cache_page(uint32_t page);
+static bool          flush_cache_page(cache_page_t* cache_page);
 
 
 //  ***************************************************************************
@@ -43,20 +67,58 @@ void veeprom_init(void) {
     }*/
 }
 
+//  ***************************************************************************
+/// @brief  Virtual EEPROM process
+/// @note   Call from main loop. Dirty pages are written to flash if no
+///         writes during VEEPROM_CACHE_IDLE_TIMEOUT
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void veeprom_process(void) {
+    
+    if (get_time_ms() - last_write_time < VEEPROM_CACHE_IDLE_TIMEOUT) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < VEEPROM_CACHE_PAGE_COUNT; ++i) {
+        if (cache[i].is_dirty == true) {
+            veeprom_commit();
+            return;
+        }
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Write all dirty cache pages to flash
+/// @param  none
+/// @return true - write success, false - fail
+//  ***************************************************************************
+bool veeprom_commit(void) {
+    
+    bool result = true;
+    for (uint32_t i = 0; i < VEEPROM_CACHE_PAGE_COUNT; ++i) {
+        
+        if (flush_cache_page(&cache[i]) == false) {
+            callback_set_memory_error(ERROR_MODULE_VEEPROM);
+            result = false;
+        }
+    }
+    return result;
+}
+
 //  ***************************************************************************
 /// @brief  Calculate and write VEEPROM checksum
-/// @note   none
+/// @note   Cache is committed
 /// @return true - write success, false - fail
 //  ***************************************************************************
 bool veeprom_update_checksum(void) {
     
     uint32_t checksum = calculate_checksum();
     
-    if (flash_write_32(VEEPROM_FLASH_START_ADDRESS + VEEPROM_CHECKSUM_ADDRESS, checksum) == false) {
-        callback_set_memory_error(ERROR_MODULE_VEEPROM);
+    if (veeprom_write_32(VEEPROM_CHECKSUM_ADDRESS, checksum) == false) {
         return false;
     }
-    return true;
+    return veeprom_commit();
 }
 
 //  ***************************************************************************
@@ -71,7 +133,9 @@ uint8_t veeprom_read_8(uint32_t veeprom_address) {
         return 0;
     }
     
-    return flash_read_8(VEEPROM_FLASH_START_ADDRESS + veeprom_address);
+    uint8_t data = 0;
+    veeprom_read_bytes(veeprom_address, &data, 1);
+    return data;
 }
 
 //  ***************************************************************************
@@ -86,7 +150,10 @@ uint16_t veeprom_read_16(uint32_t veeprom_address) {
         return 0;
     }
     
-    return flash_read_16(VEEPROM_FLASH_START_ADDRESS + veeprom_address);
+    uint8_t data[2] = {0};
+    veeprom_read_bytes(veeprom_address, data, 2);
+    
+    return (data[0] << 8) | (data[1] << 0);
 }
 
 //  ***************************************************************************
@@ -101,11 +168,15 @@ uint32_t veeprom_read_32(uint32_t veeprom_address) {
         return 0;
     }
     
-    return flash_read_32(VEEPROM_FLASH_START_ADDRESS + veeprom_address);
+    uint8_t data[4] = {0};
+    veeprom_read_bytes(veeprom_address, data, 4);
+    
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3] << 0);
 }
 
 //  ***************************************************************************
 /// @brief  Read data from virtual EEPROM
+/// @note   Cached pages are read from cache
 /// @param  address: address to EEPROM memory cell
 /// @param  buffer: buffer address
 /// @param  size: count bytes for read
@@ -118,7 +189,27 @@ void veeprom_read_bytes(uint32_t veeprom_address, uint8_t* buffer, uint32_t size
         return;
     }
     
-    flash_read_bytes(VEEPROM_FLASH_START_ADDRESS + veeprom_address, buffer, size);
+    while (size != 0) {
+        
+        uint32_t page = veeprom_address / VEEPROM_PAGE_SIZE;
+        uint32_t inpage_address = veeprom_address % VEEPROM_PAGE_SIZE;
+        uint32_t part_size = VEEPROM_PAGE_SIZE - inpage_address;
+        if (part_size > size) {
+            part_size = size;
+        }
+        
+        const cache_page_t* cache_page = find_cache_page(page);
+        if (cache_page != NULL) {
+            memcpy(buffer, &cache_page->data[inpage_address], part_size);
+        }
+        else {
+            flash_read_bytes(VEEPROM_FLASH_START_ADDRESS + veeprom_address, buffer, part_size);
+        }
+        
+        veeprom_address += part_size;
+        buffer += part_size;
+        size -= part_size;
+    }
 }
 
 //  ***************************************************************************
@@ -133,12 +224,7 @@ bool veeprom_write_8(uint32_t veeprom_address, uint8_t data) {
         return false;
     }
     
-    if (flash_write_8(VEEPROM_FLASH_START_ADDRESS + veeprom_address, data) == false) {
-        callback_set_memory_error(ERROR_MODULE_VEEPROM);
-        return false;
-    }
-    
-    return true;
+    return veeprom_write_bytes(veeprom_address, &data, 1);
 }
 
 //  ***************************************************************************
@@ -153,12 +239,8 @@ bool veeprom_write_16(uint32_t veeprom_address, uint16_t data) {
         return false;
     }
     
-    if (flash_write_16(VEEPROM_FLASH_START_ADDRESS + veeprom_address, data) == false) {
-        callback_set_memory_error(ERROR_MODULE_VEEPROM);
-        return false;
-    }
-    
-    return true;
+    uint8_t bytes[2] = { data >> 8, data & 0xFF };
+    return veeprom_write_bytes(veeprom_address, bytes, 2);
 }
 
 //  ***************************************************************************
@@ -173,16 +255,14 @@ bool veeprom_write_32(uint32_t veeprom_address, uint32_t data) {
         return false;
     }
     
-    if (flash_write_32(VEEPROM_FLASH_START_ADDRESS + veeprom_address, data) == false) {
-        callback_set_memory_error(ERROR_MODULE_VEEPROM);
-        return false;
-    }
-    
-    return true;
+    uint8_t bytes[4] = { data >> 24, (data >> 16) & 0xFF, (data >> 8) & 0xFF, data & 0xFF };
+    return veeprom_write_bytes(veeprom_address, bytes, 4);
 }
 
 //  ***************************************************************************
 /// @brief  Write data to virtual EEPROM
+/// @note   Data written to cache. Flash is written on veeprom_commit() call,
+///         on idle timeout or on page eviction
 /// @param  address: address to EEPROM memory cell
 /// @param  data: buffer address
 /// @param  size: count bytes for write
@@ -195,11 +275,37 @@ bool veeprom_write_bytes(uint32_t veeprom_address, const uint8_t* data, uint32_t
         return false;
     }
     
-    if (flash_write_bytes(VEEPROM_FLASH_START_ADDRESS + veeprom_address, data, size) == false) {
-        callback_set_memory_error(ERROR_MODULE_VEEPROM);
-        return false;
+    while (size != 0) {
+        
+        uint32_t page = veeprom_address / VEEPROM_PAGE_SIZE;
+        uint32_t inpage_address = veeprom_address % VEEPROM_PAGE_SIZE;
+        uint32_t part_size = VEEPROM_PAGE_SIZE - inpage_address;
+        if (part_size > size) {
+            part_size = size;
+        }
+        
+        cache_page_t* cache_page = find_cache_page(page);
+        if (cache_page == NULL) {
+            cache_page = load_cache_page(page);
+        }
+        if (cache_page == NULL) {
+            callback_set_memory_error(ERROR_MODULE_VEEPROM);
+            return false;
+        }
+        
+        // Page become dirty only if data changed
+        if (memcmp(&cache_page->data[inpage_address], data, part_size) != 0) {
+            memcpy(&cache_page->data[inpage_address], data, part_size);
+            cache_page->is_dirty = true;
+        }
+        cache_page->last_access_time = get_time_ms();
+        
+        veeprom_address += part_size;
+        data += part_size;
+        size -= part_size;
     }
     
+    last_write_time = get_time_ms();
     return true;
 }
 
@@ -216,8 +322,83 @@ static uint32_t calculate_checksum(void) {
     
     uint32_t checksum = 0;
     for (uint32_t i = 0; i < VEEPROM_DATA_END_ADDRESS; i += 4) {
-        checksum += flash_read_32(VEEPROM_FLASH_START_ADDRESS + i);
+        checksum += veeprom_read_32(i);
     }
     
     return checksum;
+}
+
+//  ***************************************************************************
+/// @brief  Find page in cache
+/// @param  page: VEEPROM page number
+/// @return Cache page or NULL if page is not cached
+//  ***************************************************************************
+static cache_page_t* find_cache_page(uint32_t page) {
+    
+    for (uint32_t i = 0; i < VEEPROM_CACHE_PAGE_COUNT; ++i) {
+        if (cache[i].is_valid == true && cache[i].page == page) {
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+//  ***************************************************************************
+/// @brief  Load page from flash to cache
+/// @note   Free or least recently used cache page is used. Evicted dirty
+///         page is written to flash
+/// @param  page: VEEPROM page number
+/// @return Cache page or NULL if fail
+//  ***************************************************************************
+static cache_page_t* load_cache_page(uint32_t page) {
+    
+    if (page >= VEEPROM_PAGE_COUNT) {
+        return NULL;
+    }
+    
+    // Select page for eviction
+    cache_page_t* cache_page = &cache[0];
+    for (uint32_t i = 0; i < VEEPROM_CACHE_PAGE_COUNT; ++i) {
+        
+        if (cache[i].is_valid == false) {
+            cache_page = &cache[i];
+            break;
+        }
+        if (get_time_ms() - cache[i].last_access_time > get_time_ms() - cache_page->last_access_time) {
+            cache_page = &cache[i];
+        }
+    }
+    
+    if (flush_cache_page(cache_page) == false) {
+        return NULL;
+    }
+    
+    flash_read_bytes(VEEPROM_FLASH_START_ADDRESS + page * VEEPROM_PAGE_SIZE, cache_page->data, VEEPROM_PAGE_SIZE);
+    cache_page->page = page;
+    cache_page->is_dirty = false;
+    cache_page->is_valid = true;
+    return cache_page;
+}
+
+//  ***************************************************************************
+/// @brief  Write cache page to flash if it is dirty
+/// @param  cache_page: cache page
+/// @return true - write success, false - fail
+//  ***************************************************************************
+static bool flush_cache_page(cache_page_t* cache_page) {
+    
+    if (cache_page->is_dirty == false) {
+        return true;
+    }
+    
+    uint32_t flash_address = VEEPROM_FLASH_START_ADDRESS + cache_page->page * VEEPROM_PAGE_SIZE;
+    if (flash_write_bytes(flash_address, cache_page->data, VEEPROM_PAGE_SIZE) == false) {
+        return false;
+    }
+    
+    if (veeprom_flash_write_count < 0xFFFF) {
+        ++veeprom_flash_write_count;
+    }
+    cache_page->is_dirty = false;
+    return true;
 }
\ No newline at end of file
@@ -9,20 +9,52 @@
 #include <string.h>
 #include "ram_map.h"
 #include "systimer.h"
-#include "usart3_pdc.h"
+#include "usart_pdc.h"
+#include "crc16.h"
+#include "telemetry.h"
+#include "foot_target.h"
+#include "time_sync.h"
+#include "multimedia.h"
 #include "error_handling.h"
 
 #define USART_BAUD_RATE                         (500000)
-#define CRC16_POLYNOM							(0xA001)
+#define USART_TX_BUFFER_COUNT                   (2)         // Ping-pong buffers: telemetry frame fill while response transmitting
+#define USART_RX_BUFFER_SIZE                    (2048)      // RX ring size (power of 2), two frames
+#define USART_RX_TIMEOUT                        (35 * 8)    // Bit periods, radio module may pause inside frame
 
 
-static wireless_frame_t wireless_frame = {0};
+static uint8_t usart_tx_buffer[USART_TX_BUFFER_COUNT][WIRELESS_MODBUS_FRAME_SIZE] = { 0 };
+static uint8_t usart_rx_buffer[USART_RX_BUFFER_SIZE] = { 0 };
 
+static usart_pdc_t usart = {
+	.instance = USART_PDC_USART3,
+	.tx_buffer = usart_tx_buffer[0],
+	.tx_buffer_size = WIRELESS_MODBUS_FRAME_SIZE,
+	.tx_buffer_count = USART_TX_BUFFER_COUNT,
+	.rx_buffer = usart_rx_buffer,
+	.rx_buffer_size = USART_RX_BUFFER_SIZE,
+	.rx_timeout = USART_RX_TIMEOUT
+};
 
-static bool is_wireless_modbus_frame_detected(const uint8_t* data, uint32_t data_size);
-static void read_ram_command_handler(wireless_frame_t* frame);
-static void write_ram_command_handler(wireless_frame_t* frame);
-static uint16_t calculate_crc16(const uint8_t* frame, uint32_t size);
+static wireless_frame_t request_copy = { 0 };		// Request wrapped around RX ring end or request with side effects
+static uint16_t rx_crc = CRC16_INIT_VALUE;
+static uint32_t rx_crc_size = 0;				// Frame bytes folded to rx_crc
+
+
+static void process_request(void);
+static void push_telemetry(void);
+static void update_rx_crc(void);
+static void release_rx_frame(void);
+static bool is_wireless_modbus_frame_detected(const uint8_t* data, uint32_t data_size, uint16_t crc);
+static bool is_request_with_side_effects(uint8_t function_code);
+static void read_ram_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void write_ram_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void read_ram_ranges_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void subscribe_telemetry_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void foot_targets_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void time_sync_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void read_multimedia_data_size_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
+static void read_multimedia_data_command_handler(const wireless_frame_t* request, wireless_frame_t* response);
 
 
 //  ***************************************************************************
@@ -31,8 +63,10 @@ static uint16_t calculate_crc16(const uint8_t* frame, uint32_t size);
 //  ***************************************************************************
 void wireless_modbus_init(void) {
 	
-	usart3_init(USART_BAUD_RATE);
-	usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+	usart_pdc_init(&usart, USART_BAUD_RATE);
+	usart_pdc_start_rx(&usart);
+	rx_crc = CRC16_INIT_VALUE;
+	rx_crc_size = 0;
 }
 
 //  ***************************************************************************
@@ -41,74 +75,188 @@ void wireless_modbus_init(void) {
 //  ***************************************************************************
 void wireless_modbus_process(void) {
 
+	process_request();
+	
+	// Push telemetry frame if TX buffer is free
+	if (telemetry_is_push_required() == true && usart_pdc_is_tx_buffer_available(&usart) == true) {
+		push_telemetry();
+	}
+}
+
+
+
+
+
+//  ***************************************************************************
+/// @brief	Process received request
+/// @return	none
+//  ***************************************************************************
+static void process_request(void) {
+
 	// Check USART errors
-	if (usart3_is_error() == true) {
-		usart3_reset(true, true);
-		usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+	if (usart_pdc_is_error(&usart) == true) {
+		usart_pdc_reset(&usart, true, true);
+		usart_pdc_start_rx(&usart);
+		rx_crc = CRC16_INIT_VALUE;
+		rx_crc_size = 0;
 		return;
 	}
 	
-	// Check frame received
-	if (usart3_is_frame_received() == false) {
+	// Calculate CRC for already received bytes
+	update_rx_crc();
+	
+	// Check frame received. Next frame is receiving to RX ring
+	if (usart_pdc_is_frame_received(&usart) == false) {
 		return;
 	}
 	
-	// Check complete transmit response
-	if (usart3_is_tx_complete() == false) {
-		usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+	// Wait free TX buffer. Frame stay in RX ring
+	if (usart_pdc_is_tx_buffer_available(&usart) == false) {
 		return;
 	}
 	
-
-	const uint8_t* recv_data = usart3_get_internal_rx_buffer_address();
-	uint32_t data_size = usart3_get_frame_size();
+	// Get frame in RX ring. Frame with other size is not wireless frame
+	update_rx_crc();
+	uint32_t data_size = usart_pdc_get_frame_size(&usart);
+	const uint8_t* recv_data = NULL;
+	if (data_size == WIRELESS_MODBUS_FRAME_SIZE && rx_crc_size == data_size) {
+		recv_data = usart_pdc_get_frame(&usart, (uint8_t*)&request_copy);
+	}
 	
 	// Verify frame
-	if (is_wireless_modbus_frame_detected(recv_data, data_size) == false) {
-		usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+	if (recv_data == NULL || is_wireless_modbus_frame_detected(recv_data, data_size, rx_crc) == false) {
+		release_rx_frame();
 		return;
 	}
 
-	// Process frame
-	memcpy(&wireless_frame, recv_data, WIRELESS_MODBUS_FRAME_SIZE);
-	switch (wireless_frame.function_code) {
+	// Request with side effects is copied out of RX ring and checked before
+	// processing: receive may overwrite ring while handler apply request data
+	if (is_request_with_side_effects(((const wireless_frame_t*)recv_data)->function_code) == true && recv_data != (const uint8_t*)&request_copy) {
+		memcpy(&request_copy, recv_data, WIRELESS_MODBUS_FRAME_SIZE);
+		if (usart_pdc_is_frame_valid(&usart) == false) {
+			release_rx_frame();
+			return;
+		}
+		recv_data = (const uint8_t*)&request_copy;
+	}
+
+	// Process frame in place: request in RX ring, response in TX buffer
+	const wireless_frame_t* request = (const wireless_frame_t*)recv_data;
+	wireless_frame_t* response = (wireless_frame_t*)usart_pdc_get_tx_buffer(&usart);
+	response->function_code = request->function_code;
+	response->address = request->address;
+	response->bytes_count = request->bytes_count;
+	
+	switch (request->function_code) {
 		
 		case WIRELESS_MODBUS_CMD_WRITE_RAM:
-			write_ram_command_handler(&wireless_frame);
+			write_ram_command_handler(request, response);
 			break;
 		
 		case WIRELESS_MODBUS_CMD_READ_RAM:
-			read_ram_command_handler(&wireless_frame);
+			read_ram_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_READ_RAM_RANGES:
+			read_ram_ranges_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_SUBSCRIBE_TELEMETRY:
+			subscribe_telemetry_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_FOOT_TARGETS:
+			foot_targets_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_TIME_SYNC:
+			time_sync_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA_SIZE:
+			read_multimedia_data_size_command_handler(request, response);
+			break;
+		
+		case WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA:
+			read_multimedia_data_command_handler(request, response);
 			break;
 		
 		default:
-			usart3_reset(true, true);
-			usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+			release_rx_frame();
 			return;
 	}
-
-	// Prepare response
-	wireless_frame.crc = calculate_crc16((uint8_t*)&wireless_frame, WIRELESS_MODBUS_FRAME_SIZE - WIRELESS_MODBUS_FRAME_CRC_SIZE);
 	
-	// Start transmit response
-	uint8_t* tx_buffer = usart3_get_internal_tx_buffer_address();
-	memcpy(tx_buffer, &wireless_frame, WIRELESS_MODBUS_FRAME_SIZE);
-	memset(&wireless_frame, 0x00, WIRELESS_MODBUS_FRAME_SIZE);
-	usart3_start_tx(WIRELESS_MODBUS_FRAME_SIZE);
+	// Drop response if request was overwritten by receive while processing
+	// (read only requests processed in RX ring)
+	bool is_request_valid = usart_pdc_is_frame_valid(&usart);
+	release_rx_frame();
+	if (is_request_valid == false) {
+		return;
+	}
 
-	// Start receive next frame
-	usart3_start_rx(USART3_USE_INTERNAL_BUFFER, 0);
+	// Start transmit response. TX buffers swap
+	response->crc = crc16_calculate((const uint8_t*)response, WIRELESS_MODBUS_FRAME_SIZE - WIRELESS_MODBUS_FRAME_CRC_SIZE);
+	usart_pdc_start_tx(&usart, WIRELESS_MODBUS_FRAME_SIZE);
 }
 
+//  ***************************************************************************
+/// @brief	Push telemetry frame
+/// @note	Telemetry frame is variable size: CRC follow data[bytes_count]
+/// @return	none
+//  ***************************************************************************
+static void push_telemetry(void) {
+	
+	wireless_frame_t* frame = (wireless_frame_t*)usart_pdc_get_tx_buffer(&usart);
+	uint32_t frame_size = WIRELESS_MODBUS_FRAME_SIZE - WIRELESS_MODBUS_FRAME_DATA_SIZE - WIRELESS_MODBUS_FRAME_CRC_SIZE;
+	frame_size += telemetry_make_frame(frame);
+	
+	uint8_t* raw_frame = (uint8_t*)frame;
+	uint16_t crc = crc16_calculate(raw_frame, frame_size);
+	raw_frame[frame_size++] = crc & 0xFF;
+	raw_frame[frame_size++] = crc >> 8;
+	usart_pdc_start_tx(&usart, frame_size);
+}
 
+//  ***************************************************************************
+/// @brief	Fold bytes received since previous call to frame CRC
+/// @note	Bytes are processed in RX ring without copy. Frame CRC is ready
+///			when frame timeout detected. Bytes out of frame size are skipped
+/// @return	none
+//  ***************************************************************************
+static void update_rx_crc(void) {
+	
+	uint32_t size = usart_pdc_get_frame_size(&usart);
+	if (size > WIRELESS_MODBUS_FRAME_SIZE) {
+		size = WIRELESS_MODBUS_FRAME_SIZE;
+	}
+	
+	while (rx_crc_size < size) {
+		const uint8_t* chunk = NULL;
+		uint32_t chunk_size = usart_pdc_get_frame_chunk(&usart, rx_crc_size, size - rx_crc_size, &chunk);
+		rx_crc = crc16_update(rx_crc, chunk, chunk_size);
+		rx_crc_size += chunk_size;
+	}
+}
 
-
+//  ***************************************************************************
+/// @brief	Remove processed frame from receive queue
+/// @return	none
+//  ***************************************************************************
+static void release_rx_frame(void) {
+	
+	rx_crc = CRC16_INIT_VALUE;
+	rx_crc_size = 0;
+	usart_pdc_release_frame(&usart);
+}
 
 //  ***************************************************************************
 /// @brief	Check received data
+/// @param	raw_frame: frame data
+/// @param	frame_size: frame size
+/// @param	crc: frame CRC16 (include CRC field), folded while receive
 /// @return	true - wireless frame detected, false - any data
 //  ***************************************************************************
-static bool is_wireless_modbus_frame_detected(const uint8_t* raw_frame, uint32_t frame_size) {
+static bool is_wireless_modbus_frame_detected(const uint8_t* raw_frame, uint32_t frame_size, uint16_t crc) {
 	
 	// Check frame size
 	if (frame_size != WIRELESS_MODBUS_FRAME_SIZE) {
@@ -116,7 +264,6 @@ static bool is_wireless_modbus_frame_detected(const uint8_t* raw_frame, uint32_t
 	}
 	
 	// Check CRC
-	uint32_t crc = calculate_crc16(raw_frame, frame_size);
 	if (crc != 0) {
 		return false;
 	}
@@ -125,6 +272,10 @@ static bool is_wireless_modbus_frame_detected(const uint8_t* raw_frame, uint32_t
     const wireless_frame_t* wireless_frame = (const wireless_frame_t*)raw_frame;
 	if (wireless_frame->function_code != WIRELESS_MODBUS_CMD_WRITE_RAM &&
 		wireless_frame->function_code != WIRELESS_MODBUS_CMD_READ_RAM &&
+		wireless_frame->function_code != WIRELESS_MODBUS_CMD_READ_RAM_RANGES &&
+		wireless_frame->function_code != WIRELESS_MODBUS_CMD_SUBSCRIBE_TELEMETRY &&
+		wireless_frame->function_code != WIRELESS_MODBUS_CMD_FOOT_TARGETS &&
+		wireless_frame->function_code != WIRELESS_MODBUS_CMD_TIME_SYNC &&
 		wireless_frame->function_code != WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA_SIZE &&
 		wireless_frame->function_code != WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA) {
 			
@@ -134,72 +285,243 @@ static bool is_wireless_modbus_frame_detected(const uint8_t* raw_frame, uint32_t
 	return true;
 }
 
+//  ***************************************************************************
+/// @brief	Check request change device state
+/// @param	function_code: request function code
+/// @return	true - request have side effects, false - read only request
+//  ***************************************************************************
+static bool is_request_with_side_effects(uint8_t function_code) {
+	
+	return function_code == WIRELESS_MODBUS_CMD_WRITE_RAM ||
+		   function_code == WIRELESS_MODBUS_CMD_SUBSCRIBE_TELEMETRY ||
+		   function_code == WIRELESS_MODBUS_CMD_FOOT_TARGETS ||
+		   function_code == WIRELESS_MODBUS_CMD_TIME_SYNC ||
+		   function_code == WIRELESS_MODBUS_CMD_READ_MULTIMEDIA_DATA_SIZE;
+}
+
 //  ***************************************************************************
 /// @brief  Function for processing ModBus read RAM command
-/// @param  frame: pointer to wireless frame
-/// @retval frame
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
 //  ***************************************************************************
-static void read_ram_command_handler(wireless_frame_t* frame) {
+static void read_ram_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
 
 	// Check request parameters
-	if (frame->bytes_count == 0 || frame->bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE) {
-		frame->function_code |= WIRELESS_MODBUS_EXCEPTION;
+	uint16_t bytes_count = request->bytes_count;
+	if (bytes_count == 0 || bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
 		return;
 	}
 	
 	// Process command
-	if (ram_map_read(frame->address, frame->data, frame->bytes_count) == false) {
-		frame->function_code |= WIRELESS_MODBUS_EXCEPTION;
-		return;
+	if (ram_map_read(request->address, response->data, bytes_count) == false) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		bytes_count = 0;
 	}
+	
+	// Clear unused data
+	memset(&response->data[bytes_count], 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE - bytes_count);
 }
 
 //  ***************************************************************************
 /// @brief  Function for processing ModBus write RAM command
-/// @param  frame: pointer to wireless frame
-/// @retval frame
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void write_ram_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	// Response not contain data
+	memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+	
+	// Check request parameters
+	if (request->bytes_count == 0 || request->bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+	
+	// Process command
+	if (ram_map_write(request->address, request->data, request->bytes_count) == false) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+}
+
 //  ***************************************************************************
-static void write_ram_command_handler(wireless_frame_t* frame) {
+/// @brief  Function for processing ModBus read several RAM ranges command
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void read_ram_ranges_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	// Check ranges count
+	uint32_t range_count = request->bytes_count;
+	if (range_count == 0 || range_count > WIRELESS_MODBUS_FRAME_DATA_SIZE / sizeof(wireless_ram_range_t)) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+		return;
+	}
+	
+	// Process command
+	const wireless_ram_range_t* range = (const wireless_ram_range_t*)request->data;
+	uint32_t total_bytes_count = 0;
+	for (uint32_t i = 0; i < range_count; ++i, ++range) {
+		
+		// Check range parameters and append range data to response
+		uint32_t bytes_count = range->bytes_count;
+		if (bytes_count == 0 || total_bytes_count + bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE ||
+			ram_map_read(range->address, &response->data[total_bytes_count], bytes_count) == false) {
+			
+			response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+			total_bytes_count = 0;
+			break;
+		}
+		total_bytes_count += bytes_count;
+	}
+	response->bytes_count = total_bytes_count;
+	
+	// Clear unused data
+	memset(&response->data[total_bytes_count], 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE - total_bytes_count);
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing subscribe to telemetry command
+/// @note   Request: address - push period [ms] (0 - unsubscribe),
+///         bytes_count - ranges count, data - wireless_ram_range_t list
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void subscribe_telemetry_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	// Response not contain data
+	memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+	
+	if (request->address == 0) {
+		telemetry_unsubscribe();
+		return;
+	}
 	
 	// Check request parameters
-	if (frame->bytes_count == 0 || frame->bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE) {
-		frame->function_code |= WIRELESS_MODBUS_EXCEPTION;
+	if (request->bytes_count > WIRELESS_MODBUS_FRAME_DATA_SIZE / sizeof(wireless_ram_range_t)) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
 		return;
 	}
 	
 	// Process command
-	if (ram_map_write(frame->address, frame->data, frame->bytes_count) == false) {
-		frame->function_code |= WIRELESS_MODBUS_EXCEPTION;
+	if (telemetry_subscribe((const wireless_ram_range_t*)request->data, request->bytes_count, request->address) == false) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+}
+
+//  ***************************************************************************
+/// @brief  Function for processing foot targets stream frame
+/// @note   Request: bytes_count - FOOT_TARGET_FRAME_SIZE, data - frame.
+///         Response: data - [sequence][error mask]
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void foot_targets_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+	response->bytes_count = 0;
+	
+	// Check request parameters
+	if (request->bytes_count != FOOT_TARGET_FRAME_SIZE) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
 		return;
 	}
 	
-	// Clear written data
-	memset(frame->data, 0x00, WIRELESS_MODBUS_FRAME_SIZE);
+	// Process command
+	if (foot_target_process_frame(request->data, response->data) == false) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+	response->bytes_count = FOOT_TARGET_RESPONSE_SIZE;
 }
 
+//  ***************************************************************************
+/// @brief  Function for processing time synchronization command
+/// @note   Request: bytes_count - TIME_SYNC_REQUEST_SIZE, data - [T1][T4 of
+///         previous exchange]. Response: data - [T1][T2][T3][offset][delay]
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void time_sync_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+	response->bytes_count = 0;
+	
+	// Check request parameters
+	if (request->bytes_count != TIME_SYNC_REQUEST_SIZE) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+	
+	time_sync_process_request(request->data, response->data);
+	response->bytes_count = TIME_SYNC_RESPONSE_SIZE;
+}
 
+//  ***************************************************************************
+/// @brief  Function for processing read multimedia data size command
+/// @note   Request: address - blob ID. Response: bytes_count - 4,
+///         data - blob size (uint32). Blob is prepared for chunks read
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
+//  ***************************************************************************
+static void read_multimedia_data_size_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
+	
+	memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+	response->bytes_count = 0;
+	
+	uint32_t size = 0;
+	if (multimedia_get_blob_size(request->address, &size) == false) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		return;
+	}
+	memcpy(response->data, &size, sizeof(size));
+	response->bytes_count = sizeof(size);
+}
 
 //  ***************************************************************************
-/// @brief  Calculate frame CRC16
-/// @param  wireless_frame: pointer to wireless frame
-/// @return CRC16 value
+/// @brief  Function for processing read multimedia data command
+/// @note   Request: address - blob ID, bytes_count - max chunk size (0 - max),
+///         data - chunk offset (uint32). Response: bytes_count - 4 + chunk
+///         size, data - chunk offset (uint32) and chunk. Transfer is resumed
+///         by request with offset of first missed chunk
+/// @param  request: pointer to request frame
+/// @param  response: pointer to response frame
+/// @retval response
 //  ***************************************************************************
-static uint16_t calculate_crc16(const uint8_t* frame, uint32_t size) {
+static void read_multimedia_data_command_handler(const wireless_frame_t* request, wireless_frame_t* response) {
 	
-	uint16_t crc16 = 0xFFFF;
-	uint16_t data = 0;
-	uint16_t k = 0;
+	uint32_t offset = 0;
+	memcpy(&offset, request->data, sizeof(offset));
 	
-	while (size--) {
-		crc16 ^= *frame++;
-		k = 8;
-		while (k--) {
-			data = crc16;
-			crc16 >>= 1;
-			if (data & 0x0001) {
-				crc16 ^= CRC16_POLYNOM;
-			}
-		}
+	uint32_t bytes_count = request->bytes_count;
+	if (bytes_count == 0 || bytes_count > WIRELESS_MODBUS_MULTIMEDIA_MAX_CHUNK_SIZE) {
+		bytes_count = WIRELESS_MODBUS_MULTIMEDIA_MAX_CHUNK_SIZE;
+	}
+	
+	// Process command
+	uint8_t* chunk = &response->data[WIRELESS_MODBUS_MULTIMEDIA_OFFSET_SIZE];
+	bytes_count = multimedia_read(request->address, offset, chunk, bytes_count);
+	if (bytes_count == 0) {
+		response->function_code |= WIRELESS_MODBUS_EXCEPTION;
+		response->bytes_count = 0;
+		memset(response->data, 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE);
+		return;
 	}
-	return crc16;
+	memcpy(response->data, &offset, sizeof(offset));
+	response->bytes_count = WIRELESS_MODBUS_MULTIMEDIA_OFFSET_SIZE + bytes_count;
+	
+	// Clear unused data
+	memset(&response->data[response->bytes_count], 0x00, WIRELESS_MODBUS_FRAME_DATA_SIZE - response->bytes_count);
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+//  ***************************************************************************
+/// @file    crc16_benchmark.c
+/// @author  NeoProg
+/// @brief   Host benchmark: table-driven CRC16 against previous bit loop
+/// @note    Build and run from repository root:
+///          gcc -O2 -I Skynet/include benchmark/crc16_benchmark.c -o crc16_benchmark
+///          ./crc16_benchmark
+///          Cycles are read by TSC on x86 hosts, on other hosts time is
+///          reported in ns instead of cycles
+//  ***************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../Skynet/source/crc16.c"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIME_UNIT                       "cycle"
+static uint64_t get_ticks(void) { return __rdtsc(); }
+#else
+#define TIME_UNIT                       "ns"
+static uint64_t get_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+#define CRC16_POLYNOM                   (0xA001)
+#define ITERATION_COUNT                 (20000)
+#define DMA_CHUNK_SIZE                  (64)        // Bytes folded per crc16_update() call in chunk test
+
+
+//  ***************************************************************************
+/// @brief  Calculate CRC16 by bits (previous calculate_crc16() of modbus.c
+///         and wireless_modbus.c)
+/// @param  frame: pointer to data
+/// @param  size: data size
+/// @return CRC16 value
+//  ***************************************************************************
+static uint16_t calculate_crc16_bitwise(const uint8_t* frame, uint32_t size) {
+
+    uint16_t crc16 = 0xFFFF;
+    uint16_t data = 0;
+    uint16_t k = 0;
+
+    while (size--) {
+        crc16 ^= *frame++;
+        k = 8;
+        while (k--) {
+            data = crc16;
+            crc16 >>= 1;
+            if (data & 0x0001) {
+                crc16 ^= CRC16_POLYNOM;
+            }
+        }
+    }
+    return crc16;
+}
+
+//  ***************************************************************************
+/// @brief  Calculate CRC16 by DMA_CHUNK_SIZE parts, as receive path does
+/// @param  data: pointer to data
+/// @param  size: data size
+/// @return CRC16 value
+//  ***************************************************************************
+static uint16_t calculate_crc16_chunks(const uint8_t* data, uint32_t size) {
+
+    uint16_t crc = CRC16_INIT_VALUE;
+    for (uint32_t offset = 0; offset < size; offset += DMA_CHUNK_SIZE) {
+        uint32_t chunk_size = (size - offset < DMA_CHUNK_SIZE) ? size - offset : DMA_CHUNK_SIZE;
+        crc = crc16_update(crc, &data[offset], chunk_size);
+    }
+    return crc;
+}
+
+//  ***************************************************************************
+/// @brief  Measure CRC function speed
+/// @param  calculate: CRC function
+/// @param  data: pointer to data
+/// @param  size: data size
+/// @param  crc: calculated CRC
+/// @return bytes per time unit
+//  ***************************************************************************
+static double measure(uint16_t (*calculate)(const uint8_t*, uint32_t), const uint8_t* data, uint32_t size, uint16_t* crc) {
+
+    volatile uint16_t result = 0;
+    uint64_t start = get_ticks();
+    for (uint32_t i = 0; i < ITERATION_COUNT; ++i) {
+        result = calculate(data, size);
+    }
+    uint64_t ticks = get_ticks() - start;
+
+    *crc = result;
+    return (double)size * ITERATION_COUNT / (double)ticks;
+}
+
+
+int main(void) {
+
+    static const uint32_t frame_sizes[] = { 8, 128, 1024 };     // Short request, wired frame, wireless frame
+
+    static uint8_t data[1024];
+    srand(1);
+    for (uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = rand() & 0xFF;
+    }
+
+    printf("%-6s %14s %14s %14s %8s\n", "size", "bitwise", "table", "table chunks", "speedup");
+    for (uint32_t i = 0; i < sizeof(frame_sizes) / sizeof(frame_sizes[0]); ++i) {
+
+        uint32_t size = frame_sizes[i];
+        uint16_t crc_bitwise = 0;
+        uint16_t crc_table = 0;
+        uint16_t crc_chunks = 0;
+        double bitwise = measure(calculate_crc16_bitwise, data, size, &crc_bitwise);
+        double table = measure(crc16_calculate, data, size, &crc_table);
+        double chunks = measure(calculate_crc16_chunks, data, size, &crc_chunks);
+
+        if (crc_bitwise != crc_table || crc_bitwise != crc_chunks) {
+            printf("CRC mismatch for size %u: 0x%04X 0x%04X 0x%04X\n", size, crc_bitwise, crc_table, crc_chunks);
+            return 1;
+        }
+        printf("%-6u %14.3f %14.3f %14.3f %7.1fx\n", size, bitwise, table, chunks, table / bitwise);
+    }
+    printf("Values are bytes per %s\n", TIME_UNIT);
+    return 0;
+}
\ No newline at end of file
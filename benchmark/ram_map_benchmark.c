@@ -0,0 +1,297 @@
+//  ***************************************************************************
+/// @file    ram_map_benchmark.c
+/// @author  NeoProg
+/// @brief   Host benchmark: RAM map region descriptors against previous
+///          byte pointer table
+/// @note    Build and run from repository root:
+///          gcc -O2 benchmark/ram_map_benchmark.c -o ram_map_benchmark
+///          ./ram_map_benchmark
+///          Region lookup and copy are the same as in ram_map.c (keep in
+///          sync), region layout follows RAM map 0x0000 - 0x024F.
+///          Cycles are read by TSC on x86 hosts, on other hosts time is
+///          reported in ns instead of cycles
+//  ***************************************************************************
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIME_UNIT                       "cycles"
+static uint64_t get_ticks(void) { return __rdtsc(); }
+#else
+#define TIME_UNIT                       "ns"
+static uint64_t get_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+#define ITERATION_COUNT                 (200000)
+#define RUN_COUNT                       (10)
+#define READ_SIZE                       (32)
+#define BYTE_TABLE_SIZE                 (0x0300)    // Byte pointer table for benchmark layout
+#define BASELINE_BYTE_TABLE_SIZE        (512)       // Byte pointer table size before region descriptors
+#define FIRMWARE_RAM_MAP_SIZE           (0x7000)    // RAM_MAP_SIZE, include trajectory buffer
+#define TARGET_POINTER_SIZE             (4)         // Cortex-M3
+#define TARGET_REGION_DESCRIPTOR_SIZE   (12)        // sizeof(ram_region_t) on Cortex-M3
+
+#define RAM_ACCESS_READ                 (0x01)
+#define RAM_ACCESS_WRITE                (0x02)
+#define RAM_ACCESS_RW                   (RAM_ACCESS_READ | RAM_ACCESS_WRITE)
+
+#define RAM_PUT_REGION(ram_addr, ptr, elem_size, count, acc)  { .address = (ram_addr), .size = (elem_size) * (count), .element_size = (elem_size), .access = (acc), .data = (uint8_t*)(ptr) }
+
+#define RAM_PUT_BYTE(ram_addr, var, acc)            RAM_PUT_REGION(ram_addr, &(var), 1, 1, acc)
+#define RAM_PUT_WORD(ram_addr, var, acc)            RAM_PUT_REGION(ram_addr, &(var), 2, 1, acc)
+#define RAM_PUT_DWORD(ram_addr, var, acc)           RAM_PUT_REGION(ram_addr, &(var), 4, 1, acc)
+#define RAM_PUT_BYTES(ram_addr, ptr, count, acc)    RAM_PUT_REGION(ram_addr, ptr, 1, count, acc)
+#define RAM_PUT_WORDS(ram_addr, ptr, count, acc)    RAM_PUT_REGION(ram_addr, ptr, 2, count, acc)
+
+typedef struct {
+    uint16_t address;
+    uint16_t size;
+    uint8_t  element_size;
+    uint8_t  access;
+    uint8_t* data;
+} ram_region_t;
+
+
+static uint32_t dwords[8];
+static uint16_t words[32];
+static uint8_t  bytes[16];
+static int8_t   link_angles[18];
+static int8_t   link_angles_override[18];
+static uint16_t pwm_isr_statistic[7 * 7];
+static uint16_t overrun_count[11];
+static uint16_t profiler_statistic[11 * 6];
+static uint16_t modbus_statistic[2 * 20];
+
+static const ram_region_t ram_map[] = {
+
+    RAM_PUT_DWORD(0x0000, dwords[0],                    RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x000F, bytes[0],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0010, words[0],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0012, bytes[1],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0013, bytes[2],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0014, bytes[3],                     RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x0016, dwords[1],                    RAM_ACCESS_READ),
+
+    RAM_PUT_BYTE (0x0020, bytes[4],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x0021, bytes[5],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0022, words[1],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0024, words[2],                     RAM_ACCESS_READ),
+    RAM_PUT_DWORD(0x0026, dwords[2],                    RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x002A, words[3],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x002C, bytes[6],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0030, words[4],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0032, words[5],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0036, words[6],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x0038, words[7],                     RAM_ACCESS_READ),
+    RAM_PUT_BYTE (0x003A, bytes[7],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x003C, words[8],                     RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x003E, words[9],                     RAM_ACCESS_READ),
+
+    RAM_PUT_BYTE (0x0060, bytes[8],                     RAM_ACCESS_RW),
+    RAM_PUT_DWORD(0x0061, dwords[3],                    RAM_ACCESS_RW),
+
+    RAM_PUT_BYTES(0x00C0, link_angles, 18,              RAM_ACCESS_READ),
+    RAM_PUT_BYTES(0x00E0, link_angles_override, 18,     RAM_ACCESS_RW),
+
+    RAM_PUT_WORDS(0x0100, pwm_isr_statistic, 7 * 7,     RAM_ACCESS_READ),
+    RAM_PUT_WORDS(0x0164, overrun_count, 11,            RAM_ACCESS_READ),
+    RAM_PUT_WORD (0x017A, words[10],                    RAM_ACCESS_READ),
+    RAM_PUT_WORDS(0x017C, profiler_statistic, 11 * 6,   RAM_ACCESS_READ),
+    RAM_PUT_WORDS(0x0200, modbus_statistic, 2 * 20,     RAM_ACCESS_READ)
+};
+
+#define RAM_MAP_REGION_COUNT            (sizeof(ram_map) / sizeof(ram_map[0]))
+
+static uint8_t* byte_table[BYTE_TABLE_SIZE];
+
+
+//  ***************************************************************************
+/// @brief  Build byte pointer table from regions (previous RAM_PUT_xxx
+///         macros: big-endian byte order of multibyte variables)
+/// @param  none
+/// @return none
+//  ***************************************************************************
+static void build_byte_table(void) {
+
+    for (uint32_t r = 0; r < RAM_MAP_REGION_COUNT; ++r) {
+        const ram_region_t* region = &ram_map[r];
+        for (uint32_t i = 0; i < region->size; ++i) {
+            byte_table[region->address + i] = &region->data[i ^ (region->element_size - 1)];
+        }
+    }
+}
+
+//  ***************************************************************************
+/// @brief  Read RAM by byte pointer table (previous ram_map_read())
+/// @param  ram_address: RAM address
+/// @param  buffer: pointer to buffer
+/// @param  bytes_count: bytes count for read
+/// @return true - read data success, false - error
+//  ***************************************************************************
+static bool byte_table_read(uint32_t ram_address, uint8_t* buffer, uint32_t bytes_count) {
+
+    if (ram_address + bytes_count >= BYTE_TABLE_SIZE) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < bytes_count; ++i) {
+        buffer[i] = (byte_table[ram_address + i] != NULL) ? *(byte_table[ram_address + i]) : 0;
+    }
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Find first region which contain or follow RAM address (ram_map.c)
+/// @param  ram_address: RAM address
+/// @return Pointer to region or end of map
+//  ***************************************************************************
+static const ram_region_t* find_region(uint32_t ram_address) {
+
+    uint32_t left = 0;
+    uint32_t right = RAM_MAP_REGION_COUNT;
+    while (left < right) {
+
+        uint32_t middle = (left + right) / 2;
+        if (ram_map[middle].address + ram_map[middle].size <= ram_address) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    return &ram_map[left];
+}
+
+//  ***************************************************************************
+/// @brief  Read RAM by region descriptors (ram_map_read() of ram_map.c)
+/// @param  ram_address: RAM address
+/// @param  buffer: pointer to buffer
+/// @param  bytes_count: bytes count for read
+/// @return true - read data success, false - error
+//  ***************************************************************************
+static bool regions_read(uint32_t ram_address, uint8_t* buffer, uint32_t bytes_count) {
+
+    if (ram_address + bytes_count > BYTE_TABLE_SIZE) {
+        return false;
+    }
+
+    uint32_t end_address = ram_address + bytes_count;
+    const ram_region_t* region = find_region(ram_address);
+    const ram_region_t* map_end = &ram_map[RAM_MAP_REGION_COUNT];
+
+    while (ram_address < end_address) {
+
+        uint32_t gap_end = (region != map_end && region->address < end_address) ? region->address : end_address;
+        if (ram_address < gap_end) {
+            memset(buffer, 0x00, gap_end - ram_address);
+            buffer += gap_end - ram_address;
+            ram_address = gap_end;
+            continue;
+        }
+
+        uint32_t offset = ram_address - region->address;
+        uint32_t region_end = region->address + region->size;
+        uint32_t count = ((region_end < end_address) ? region_end : end_address) - ram_address;
+        if ((region->access & RAM_ACCESS_READ) == 0) {
+            memset(buffer, 0x00, count);
+        }
+        else if (region->element_size == 1) {
+            memcpy(buffer, &region->data[offset], count);
+        }
+        else {
+            uint32_t swap_mask = region->element_size - 1;
+            for (uint32_t i = 0; i < count; ++i) {
+                buffer[i] = region->data[(offset + i) ^ swap_mask];
+            }
+        }
+
+        buffer += count;
+        ram_address += count;
+        ++region;
+    }
+    return true;
+}
+
+//  ***************************************************************************
+/// @brief  Measure read function speed
+/// @param  read: read function
+/// @param  ram_address: RAM address of READ_SIZE bytes block
+/// @param  buffer: read result
+/// @return time units per read
+//  ***************************************************************************
+static double measure(bool (*read)(uint32_t, uint8_t*, uint32_t), uint32_t ram_address, uint8_t* buffer) {
+
+    // Best of several runs to filter host scheduler noise
+    uint64_t best_ticks = UINT64_MAX;
+    for (uint32_t run = 0; run < RUN_COUNT; ++run) {
+        uint64_t start = get_ticks();
+        for (uint32_t i = 0; i < ITERATION_COUNT; ++i) {
+            read(ram_address, buffer, READ_SIZE);
+            __asm__ volatile("" : : "r"(buffer) : "memory");
+        }
+        uint64_t ticks = get_ticks() - start;
+        if (ticks < best_ticks) {
+            best_ticks = ticks;
+        }
+    }
+    return (double)best_ticks / ITERATION_COUNT;
+}
+
+
+int main(void) {
+
+    static const struct {
+        uint32_t    address;
+        const char* name;
+    } blocks[] = {
+        { 0x0000, "header (small variables, gaps)" },
+        { 0x0020, "status words"                   },
+        { 0x00C0, "link angles (byte array)"       },
+        { 0x0100, "PWM ISR statistic (words)"      },
+        { 0x017C, "profiler statistic (words)"     },
+        { 0x0200, "ModBus statistic (words)"       }
+    };
+
+    // Fill variables by pattern
+    uint8_t* areas[] = { (uint8_t*)dwords, (uint8_t*)words, bytes, (uint8_t*)link_angles, (uint8_t*)link_angles_override,
+                         (uint8_t*)pwm_isr_statistic, (uint8_t*)overrun_count, (uint8_t*)profiler_statistic, (uint8_t*)modbus_statistic };
+    uint32_t sizes[] = { sizeof(dwords), sizeof(words), sizeof(bytes), sizeof(link_angles), sizeof(link_angles_override),
+                         sizeof(pwm_isr_statistic), sizeof(overrun_count), sizeof(profiler_statistic), sizeof(modbus_statistic) };
+    uint8_t value = 1;
+    for (uint32_t i = 0; i < sizeof(areas) / sizeof(areas[0]); ++i) {
+        for (uint32_t k = 0; k < sizes[i]; ++k) {
+            areas[i][k] = value++;
+        }
+    }
+    build_byte_table();
+
+    printf("%u byte reads, %s per read\n", READ_SIZE, TIME_UNIT);
+    printf("%-32s %12s %12s %8s\n", "block", "byte table", "regions", "speedup");
+    for (uint32_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); ++i) {
+
+        uint8_t byte_table_data[READ_SIZE];
+        uint8_t regions_data[READ_SIZE];
+        double byte_table_time = measure(byte_table_read, blocks[i].address, byte_table_data);
+        double regions_time = measure(regions_read, blocks[i].address, regions_data);
+
+        if (memcmp(byte_table_data, regions_data, READ_SIZE) != 0) {
+            printf("Data mismatch at 0x%04X\n", blocks[i].address);
+            return 1;
+        }
+        printf("%-32s %12.1f %12.1f %7.1fx\n", blocks[i].name, byte_table_time, regions_time, byte_table_time / regions_time);
+    }
+
+    printf("\nFlash for map on Cortex-M3:\n");
+    printf("  byte table, baseline %u entries:     %6u bytes\n", BASELINE_BYTE_TABLE_SIZE, BASELINE_BYTE_TABLE_SIZE * TARGET_POINTER_SIZE);
+    printf("  byte table, current map size 0x%04X: %6u bytes\n", FIRMWARE_RAM_MAP_SIZE, FIRMWARE_RAM_MAP_SIZE * TARGET_POINTER_SIZE);
+    printf("  region descriptors, %2u regions:     %6u bytes\n", (uint32_t)RAM_MAP_REGION_COUNT, (uint32_t)RAM_MAP_REGION_COUNT * TARGET_REGION_DESCRIPTOR_SIZE);
+    return 0;
+}
\ No newline at end of file